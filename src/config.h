@@ -38,6 +38,127 @@ extern "C" {
 /// @brief Revision date of the program.
 #define QOI_DEC_REVISION_DATE "2026-05-01"
 
+/// @brief Number of frames between debug overlay timing reports over the debug log. 0 disables the reports.
+#define QOI_DEC_OVERLAY_STATS_FRAMES 600
+
+/// @brief Set to 0 to format the debug overlay text every frame instead of replaying it from a recorded display list
+/// @details Compare the per-frame times in the debug overlay timing reports to see what the recorded display list saves
+#define QOI_DEC_OVERLAY_CACHE 1
+
+/// @brief Set to 1 to count the CPU cycles each kind of QOI chunk takes to decode and print them over the debug log after each image
+/// @details Read the log with build/qoi_profile_report. Decoding is slower while the cycles are counted
+#define QOI_DEC_PROFILE_DECODER 0
+
+/// @brief Size in bytes of the arena holding file names, encoded QOI files and decoding scratch memory with 4 MiB of RDRAM
+#define QOI_DEC_ARENA_SIZE 1048576
+
+/// @brief Size in bytes of the arena with an Expansion Pak, so bigger QOI files can be read whole
+#define QOI_DEC_ARENA_SIZE_EXPANDED 2097152
+
+/// @brief Size in bytes of the block reserved at boot that buffers of decoded images are carved out of with 4 MiB of RDRAM
+/// @details Fits a front and a back 320x240 RGBA32 image. Buffers are sized to each image so smaller images
+/// leave room for more buffers
+#define QOI_DEC_POOL_SIZE 655360
+
+/// @brief Size in bytes of the block buffers of decoded images are carved out of with an Expansion Pak
+/// @details Fits the front and back images and the cached images at 320x240 RGBA32
+#define QOI_DEC_POOL_SIZE_EXPANDED 2621440
+
+/// @brief Most buffers of decoded images kept at once, handed out or waiting to be reused
+#define QOI_DEC_POOL_BUFFERS 12
+
+/// @brief Number of decoded images kept after they leave the screen with 4 MiB of RDRAM
+/// @details Going back to a cached image shows it on the next frame without reading or decoding it again
+#define QOI_DEC_CACHED_IMAGES 0
+
+/// @brief Number of decoded images kept after they leave the screen with an Expansion Pak
+#define QOI_DEC_CACHED_IMAGES_EXPANDED 4
+
+/// @brief Most decoded images the cache can be set up to keep
+#define QOI_DEC_MAX_CACHED_IMAGES 8
+
+/// @brief Number of images after the one on screen decoded ahead into the cache with 4 MiB of RDRAM
+/// @details Kept below the number of cached images. The slideshow still decodes the next image into the back slot without a cache
+#define QOI_DEC_PREFETCH_DEPTH 0
+
+/// @brief Number of images after the one on screen decoded ahead into the cache with an Expansion Pak
+#define QOI_DEC_PREFETCH_DEPTH_EXPANDED 2
+
+/// @brief Microseconds per frame spent decoding images ahead into the cache while an image is shown
+#define QOI_DEC_PREFETCH_SLICE_US 4000
+
+/// @brief Zoom mode the viewer starts in. See qoi_zoom_mode in qoi_viewer.h
+#define QOI_DEC_DEFAULT_ZOOM QOI_ZOOM_ORIGINAL
+
+/// @brief Pixel format QOI images are decoded to. See qoi_output_format in sQOI.h
+/// @details QOI_OUTPUT_RGBA16 halves the memory written per image, QOI_OUTPUT_I8 and QOI_OUTPUT_IA8 show images in grayscale.
+/// QOI_OUTPUT_RGBA32_PREMULTIPLIED and QOI_OUTPUT_RGBA16_PREMULTIPLIED keep the edges of transparent areas clean when images are filtered
+#define QOI_DEC_OUTPUT_FORMAT QOI_OUTPUT_RGBA32
+
+/// @brief Gamma correction of the video interface. See gamma_t in libdragon
+/// @details GAMMA_NONE shows the framebuffer as sRGB, so images marked as linear in their header are converted to sRGB while decoding.
+/// GAMMA_CORRECT and GAMMA_CORRECT_DITHER show the framebuffer as linear light, so sRGB images are converted to linear while decoding
+/// and crossfades and filtering blend in linear light. The background and text colors are not converted
+#define QOI_DEC_DISPLAY_GAMMA GAMMA_NONE
+
+/// @brief Set to 1 to show images with at most 256 colors as CI8 textures, or CI4 textures for at most 16 colors
+/// @details The palette is RGBA16 so colors lose their low bits when the output format is QOI_OUTPUT_RGBA32.
+/// Only used when the output format is QOI_OUTPUT_RGBA32 or QOI_OUTPUT_RGBA16
+#define QOI_DEC_INDEXED_OUTPUT 1
+
+/// @brief What the transparent parts of RGBA images are shown over. See qoi_background_t in qoi_viewer.h
+#define QOI_DEC_BACKGROUND QOI_BACKGROUND_CHECKERBOARD
+
+/// @brief Color shown behind RGBA images and of the light squares of the checkerboard
+#define QOI_DEC_BACKGROUND_COLOR RGBA32(204, 204, 204, 255)
+
+/// @brief Color of the dark squares of the checkerboard
+#define QOI_DEC_CHECKERBOARD_COLOR RGBA32(153, 153, 153, 255)
+
+/// @brief Width and height in pixels of the squares of the checkerboard
+#define QOI_DEC_CHECKERBOARD_SIZE 8
+
+/// @brief Set to 1 to claim the data cache lines of each decoded row with the cache instruction instead of reading them from RDRAM
+/// @details Saves reading the old contents of the image buffer that are about to be overwritten. Only used on the N64
+#define QOI_DEC_CLAIM_OUTPUT_LINES 1
+
+/// @brief Set to 1 to start the viewer in slideshow mode
+#define QOI_DEC_SLIDESHOW_AT_BOOT 0
+
+/// @brief Milliseconds each image stays on screen in slideshow mode
+#define QOI_DEC_SLIDESHOW_DWELL_MS 5000
+
+/// @brief Milliseconds the transition between two images takes in slideshow mode
+#define QOI_DEC_SLIDESHOW_TRANSITION_MS 1000
+
+/// @brief Transition between images in slideshow mode. See qoi_transition_t in qoi_viewer.h
+#define QOI_DEC_SLIDESHOW_TRANSITION QOI_TRANSITION_CROSSFADE
+
+/// @brief Microseconds per frame spent decoding the next image in slideshow mode
+#define QOI_DEC_SLIDESHOW_SLICE_US 6000
+
+/// @brief Microseconds per frame spent decoding an image picked with the controller while the image before it stays on screen
+#define QOI_DEC_LOAD_SLICE_US 8000
+
+/// @brief Number of thumbnails the browser keeps. Each takes 6 KiB
+/// @details Keep it at least BROWSER_COLUMNS * (BROWSER_ROWS + 2) so the rows above and below the page are made ahead of scrolling
+#define QOI_DEC_THUMBNAIL_SLOTS 24
+
+/// @brief Microseconds per frame spent making thumbnails in the browser
+#define QOI_DEC_THUMBNAIL_SLICE_US 8000
+
+/// @brief Microseconds per frame spent decoding the next frame of a QOI animation
+#define QOI_DEC_ANIMATION_SLICE_US 8000
+
+/// @brief Set to 1 to run the navigation benchmark at boot. Holding L and R while the viewer boots runs it too
+/// @details The benchmark moves forward through every image and back again, then prints how long each switch took
+/// and how long frames took over the debug log. The controller is ignored until it is done
+#define QOI_DEC_BENCHMARK_AT_BOOT 0
+
+/// @brief Frames each image stays on screen in the benchmark before it moves on
+/// @details Gives the viewer as much time to decode images ahead as someone looking at each image for a moment
+#define QOI_DEC_BENCHMARK_DWELL_FRAMES 30
+
 #if __cplusplus
 }
 #endif
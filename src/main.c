@@ -43,6 +43,12 @@
 #include "config.h"
 
 #include "qoi_viewer.h"
+#include "qoi_arena.h"
+#include "qoi_thumbnail.h"
+#include "qoi_pool.h"
+#include "qoi_cache.h"
+#include "qoi_memory.h"
+#include "qoi_bench.h"
 
 /// @brief How many names can fit in a block
 #define POOL_IMG_SIZE 15
@@ -50,11 +56,118 @@
 /// @brief Maximum length of a string. File names are limited by libdragon to 243 characters
 #define MAX_STRING_SIZE MAX_FILENAME_LEN + 1
 
-/// @brief Raw image buffer that decoded from qoi image file
-uint8_t buffer0[IMG_BUFFER_SIZE];
+/// @brief The two raw image buffers as a front slot shown on screen and a back slot decoded into
+typedef struct image_slots {
+    /// @brief Raw image buffer of each slot from the image pool or NULL
+    uint8_t* buffers[2];
 
-/// @brief second raw image buffer that decoded from qoi image file
-uint8_t buffer1[IMG_BUFFER_SIZE];
+    /// @brief Syncpoint after the last frame that drew from each slot. 0 if none did
+    rspq_syncpoint_t lastDrawn[2];
+
+    /// @brief Whether each slot holds a still image that goes into the image cache once it leaves the screen
+    bool still[2];
+
+    /// @brief Slot on screen
+    int front;
+} image_slots_t;
+
+/// @brief Image slots the viewer shows images from
+static image_slots_t slots = {
+    .buffers = {NULL, NULL},
+    .lastDrawn = {0, 0},
+    .still = {false, false},
+    .front = 0
+};
+
+/// @brief Gets the back slot to decode into once the RDP has finished every frame that read it
+/// @param size Size in bytes the raw image buffer of the back slot needs
+/// @param still Whether a still image is decoded into the slot instead of an animation
+/// @return Raw image buffer of the back slot or NULL if the image pool has no room for it
+static uint8_t* acquire_back_slot(size_t size, bool still) {
+    int back = slots.front ^ 1;
+
+    // the slot was on screen until the last swap so frames still queued may read it
+    rspq_syncpoint_wait(slots.lastDrawn[back]);
+
+    // a buffer of the same size class is kept as is and cached images make way if the pool is full
+    do {
+        slots.buffers[back] = qoi_pool_realloc(&image_pool, slots.buffers[back], size);
+    } while (!slots.buffers[back] && qoi_cache_evict(&image_cache));
+
+    slots.still[back] = still;
+
+    return slots.buffers[back];
+}
+
+/// @brief Gives the raw image buffer of the back slot back to the image pool after an image failed to load
+/// @details The image on screen stays in the front slot
+static void release_back_slot(void) {
+    int back = slots.front ^ 1;
+
+    rspq_syncpoint_wait(slots.lastDrawn[back]);
+    qoi_pool_free(&image_pool, slots.buffers[back]);
+
+    slots.buffers[back] = NULL;
+    slots.lastDrawn[back] = 0;
+    slots.still[back] = false;
+}
+
+/// @brief Puts the image decoded into the back slot on screen
+/// @details A still image leaving the screen goes into the image cache and its slot gets a new buffer
+/// @param shown QOI info of the image leaving the screen
+static void swap_slots(const qoi_img_info_t* shown) {
+    int front = slots.front;
+
+    if (image_cache.capacity > 0 &&
+        slots.still[front] &&
+        shown->error == QOI_OK &&
+        shown->pixels == slots.buffers[front]
+    ) {
+        qoi_cache_put(&image_cache, shown, slots.lastDrawn[front]);
+
+        slots.buffers[front] = NULL;
+        slots.lastDrawn[front] = 0;
+        slots.still[front] = false;
+    }
+
+    slots.front ^= 1;
+}
+
+/// @brief Moves a still image from the image cache into the back slot
+/// @param name Name of the QOI file
+/// @param cropped Whether the image is wanted cropped
+/// @param info QOI info of the image if it is found
+/// @return true if the image was in the cache
+static bool take_cached(const char* name, bool cropped, qoi_img_info_t* info) {
+    int back = slots.front ^ 1;
+    rspq_syncpoint_t last_drawn;
+
+    if (!qoi_cache_take(&image_cache, name, cropped, info, &last_drawn)) {
+        return false;
+    }
+
+    // the buffer of the back slot makes way for the cached one
+    rspq_syncpoint_wait(slots.lastDrawn[back]);
+    qoi_pool_free(&image_pool, slots.buffers[back]);
+
+    slots.buffers[back] = info->pixels;
+    slots.lastDrawn[back] = last_drawn;
+    slots.still[back] = true;
+
+    return true;
+}
+
+/// @brief Records that the frame just submitted to the RDP reads from a raw image buffer
+/// @param pixels Raw image buffer drawn
+static void mark_slot_drawn(const uint8_t* pixels) {
+    rspq_syncpoint_t sync = rspq_syncpoint_new();
+
+    for (int i = 0; i < 2; i++) {
+        if (slots.buffers[i] == pixels) {
+            slots.lastDrawn[i] = sync;
+        }
+    }
+}
 
 /// @brief Poll controller and get input from a specific port
 /// @param port port controller from the n64
@@ -81,6 +194,9 @@ struct name_node_pool_t {
 
     /// @brief A list of names in a block
     char name[POOL_IMG_SIZE][MAX_STRING_SIZE];
+
+    /// @brief Metadata read from the header of each QOI file in the block
+    qoi_probe_info_t catalog[POOL_IMG_SIZE];
 };
 
 /// @brief Reads the names of QOI images from ROM
@@ -94,10 +210,10 @@ void readNames(name_node_pool_t* start_node) {
         
         do {
             if (node->num_images >= POOL_IMG_SIZE) {
-                // the program runs forever so no need to free pool
-                name_node_pool_t* new_node = (name_node_pool_t*)malloc(sizeof(name_node_pool_t));
+                // the program runs forever so the pool stays at the bottom of the arena
+                name_node_pool_t* new_node = (name_node_pool_t*)arena_alloc(&viewer_arena, sizeof(name_node_pool_t));
                 
-                assert(new_node != NULL);
+                assertf(new_node != NULL, "Arena is too small to hold all file names.\nIncrease QOI_DEC_ARENA_SIZE in config.h");
 
                 new_node->prev = node;
                 new_node->next = start_node;
@@ -112,6 +228,23 @@ void readNames(name_node_pool_t* start_node) {
             sys_hw_memset(node->name[node->num_images], 0, MAX_STRING_SIZE);
             snprintf(node->name[node->num_images], MAX_STRING_SIZE - 1, sbuf);
 
+            // only the header is read so every file can be checked at boot
+            qoi_probe_info_t* probe = &node->catalog[node->num_images];
+            qoi_probe(node->name[node->num_images], probe);
+
+            debugf(
+                "Catalog: %s %i x %i, %i channels, colorspace %i, %i bytes, 1/%i scale, %i frames, error %i\n",
+                node->name[node->num_images],
+                probe->width,
+                probe->height,
+                probe->channels,
+                probe->colorspace,
+                probe->fileSize,
+                1 << probe->downscaleShift,
+                probe->frameCount,
+                probe->error
+            );
+
             node->num_images++;
             
         } while (dfs_dir_findnext(sbuf+5) == FLAGS_FILE);
@@ -121,6 +254,93 @@ void readNames(name_node_pool_t* start_node) {
     }
 }
 
+/// @brief Position in the list of names of an image that can be shown
+typedef struct image_entry {
+    /// @brief Block of names the image is in
+    name_node_pool_t* node;
+
+    /// @brief Position of the image in the block
+    int index;
+} image_entry_t;
+
+/// @brief Lists every image that can be shown in the order of the names for the browser
+/// @param start_node The initial node
+/// @param count Number of images listed
+/// @return Images that can be shown, allocated from the arena for as long as the program runs
+static image_entry_t* list_images(name_node_pool_t* start_node, int* count) {
+    name_node_pool_t* node = start_node;
+    image_entry_t* entries;
+    int total = 0;
+
+    do {
+        for (int i = 0; i < node->num_images; i++) {
+            total += node->catalog[i].error == QOI_OK;
+        }
+
+        node = node->next;
+    } while (node != start_node);
+
+    entries = (image_entry_t*)arena_alloc(&viewer_arena, total * sizeof(image_entry_t));
+
+    assertf(entries != NULL, "Arena is too small to list all images.\nIncrease QOI_DEC_ARENA_SIZE in config.h");
+
+    *count = 0;
+
+    do {
+        for (int i = 0; i < node->num_images; i++) {
+            if (node->catalog[i].error == QOI_OK) {
+                entries[*count].node = node;
+                entries[(*count)++].index = i;
+            }
+        }
+
+        node = node->next;
+    } while (node != start_node);
+
+    return entries;
+}
+
+/// @brief Moves a position in the list of names to the next image that can be shown
+/// @param node Block of names the position is in
+/// @param index Index of the name in the block
+static void next_position(name_node_pool_t** node, int* index) {
+    name_node_pool_t* start_node = *node;
+    int start_index = *index;
+
+    do {
+        (*index)++;
+
+        if (*index >= (*node)->num_images) {
+            *node = (name_node_pool_t*)(*node)->next;
+            *index = 0;
+        }
+    } while (
+        (*node)->catalog[*index].error != QOI_OK &&
+        !(*node == start_node && *index == start_index)
+    );
+}
+
+/// @brief Moves a position in the list of names to the previous image that can be shown
+/// @param node Block of names the position is in
+/// @param index Index of the name in the block
+static void previous_position(name_node_pool_t** node, int* index) {
+    name_node_pool_t* start_node = *node;
+    int start_index = *index;
+
+    do {
+        (*index)--;
+
+        if (*index == -1) {
+            *node = (name_node_pool_t*)(*node)->prev;
+            *index = (*node)->num_images - 1;
+            assert(*index >= 0);
+        }
+    } while (
+        (*node)->catalog[*index].error != QOI_OK &&
+        !(*node == start_node && *index == start_index)
+    );
+}
+
 /// @brief This function initializes libdragon functions
 static inline void init_program() {
     console_init();
@@ -132,6 +352,22 @@ static inline void init_program() {
     joypad_init();
 
     dfs_init(DFS_DEFAULT_LOCATION);
+
+    // an Expansion Pak gives the arena, the image pool and the image cache more room
+    qoi_memory_plan_init(&memory_plan, get_memory_size());
+    qoi_memory_plan_report(&memory_plan);
+
+    // everything but the raw image buffers is allocated from the arena
+    bool arena_ready = arena_init(&viewer_arena, memory_plan.arenaSize);
+
+    assertf(arena_ready, "Failed to allocate %i bytes for the arena", (int)memory_plan.arenaSize);
+
+    // the raw image buffers are carved out of one block so they never fragment the heap
+    bool pool_ready = qoi_pool_init(&image_pool, memory_plan.poolSize);
+
+    assertf(pool_ready, "Failed to allocate %i bytes for the image pool", (int)memory_plan.poolSize);
+
+    qoi_cache_init(&image_cache, memory_plan.cachedImages);
 }
 
 /// @brief This function starts QOI viewer to display first QOI image decoded
@@ -142,7 +378,7 @@ void start_viewer() {
         RESOLUTION_320x240,
         DEPTH_32_BPP,
         2, // double buffered
-        GAMMA_NONE,
+        QOI_DEC_DISPLAY_GAMMA,
         FILTERS_RESAMPLE
     );
 
@@ -151,10 +387,69 @@ void start_viewer() {
 
 }
 
+/// @brief Gets the name of a texture format of a raw image buffer
+/// @param format Texture format
+/// @return Name of the format
+static const char* get_format_name(tex_format_t format) {
+    switch (format) {
+        case FMT_RGBA32: return "RGBA32";
+        case FMT_RGBA16: return "RGBA16";
+        case FMT_CI8: return "CI8";
+        case FMT_CI4: return "CI4";
+        case FMT_I8: return "I8";
+        case FMT_IA8: return "IA8";
+        default: return "unknown";
+    }
+}
+
+/// @brief Expands an RGBA16 color to 8 bits per channel
+/// @param color RGBA 5551 color
+/// @param rgba Red, green, blue and alpha of the color
+static void expand_rgba16(uint16_t color, uint8_t rgba[4]) {
+    for (int channel = 0; channel < 3; channel++) {
+        uint8_t bits = (color >> (11 - channel * 5)) & 0x1F;
+
+        rgba[channel] = (bits << 3) | (bits >> 2);
+    }
+
+    rgba[3] = (color & 1) ? 255 : 0;
+}
+
+/// @brief Gets the color of the first pixel of a raw image buffer whatever its texture format
+/// @param info QOI Image Metadata
+/// @param rgba Red, green, blue and alpha of the first pixel as the RDP reads it
+static void get_first_pixel(const qoi_img_info_t* info, uint8_t rgba[4]) {
+    const uint8_t* pixels = info->pixels;
+
+    switch (info->format) {
+        case FMT_RGBA16:
+            expand_rgba16(*(const uint16_t*)pixels, rgba);
+            break;
+        case FMT_CI8:
+            expand_rgba16(info->palette[pixels[0]], rgba);
+            break;
+        case FMT_CI4:
+            // the first pixel of each pair is in the high bits
+            expand_rgba16(info->palette[pixels[0] >> 4], rgba);
+            break;
+        case FMT_I8:
+            rgba[0] = rgba[1] = rgba[2] = rgba[3] = pixels[0];
+            break;
+        case FMT_IA8:
+            rgba[0] = rgba[1] = rgba[2] = (pixels[0] >> 4) * 17;
+            rgba[3] = (pixels[0] & 0x0F) * 17;
+            break;
+        default:
+            memcpy(rgba, pixels, 4);
+            break;
+    }
+}
+
 /// @brief Prints the first values of the pixel decoded by the QOI Decoder
 /// @param info QOI Image Metadata
 void printFirstDecodedValues(qoi_img_info_t* info) {
-    
+    uint8_t rgba[4];
+
     printf("QOI Image Viewer\n");
 
     printf("Revision Date: %s\n", QOI_DEC_REVISION_DATE);
@@ -164,23 +459,260 @@ void printFirstDecodedValues(qoi_img_info_t* info) {
         info->name,
         info->decodeTime * 1000.0f
     ); // time in ms spent decoding
-    
+
+    // palette indices and 16 bit colors are turned back into 8 bit RGBA
+    get_first_pixel(info, rgba);
+
     printf(
-        "First pixel of %s: %i %i %i %i\n", 
+        "First pixel of %s (%s): %i %i %i %i\n",
         info->name,
-        buffer0[0],
-        buffer0[1],
-        buffer0[2],
-        buffer0[3]
+        get_format_name(info->format),
+        rgba[0],
+        rgba[1],
+        rgba[2],
+        rgba[3]
     ); // get color of first pixel
 }
 
 
+/// @brief Checks if only the middle of an image is decoded the way it is shown with a zoom mode
+/// @param probe Header of the image read by the catalog
+/// @param zoom Zoom mode the image is shown with
+/// @return true if the image is bigger than the screen and shown at 1:1
+static bool is_cropped(const qoi_probe_info_t* probe, qoi_zoom_mode zoom) {
+    return probe->frameCount == 0 && zoom == QOI_ZOOM_ORIGINAL && probe->downscaleShift > 0;
+}
+
+/// @brief Gets the size of the raw image buffer an image needs the way it is shown with a zoom mode
+/// @param probe Header of the image read by the catalog
+/// @param zoom Zoom mode the image is shown with
+/// @return Size in bytes
+static size_t get_image_size(const qoi_probe_info_t* probe, qoi_zoom_mode zoom) {
+    // animations are played at the size of their canvas
+    if (probe->frameCount > 0) {
+        return getQOIBufferSize(probe->width, probe->height);
+    }
+
+    // the middle of a bigger image is shown at 1:1
+    if (is_cropped(probe, zoom)) {
+        return getQOIBufferSize(
+            probe->width < SCREEN_WIDTH ? probe->width : SCREEN_WIDTH,
+            probe->height < SCREEN_HEIGHT ? probe->height : SCREEN_HEIGHT
+        );
+    }
+
+    return getQOIBufferSize(probe->width >> probe->downscaleShift, probe->height >> probe->downscaleShift);
+}
+
+/// @brief Starts decoding a still image the way it is shown with a zoom mode
+/// @details At 1:1 an image bigger than the screen shows the middle of it at full resolution
+/// instead of all of it downscaled, so only the rows in the middle are decoded
+/// @param node Block of names the image is in
+/// @param index Position of the image in the block
+/// @param bytes Pointer to a raw image buffer
+/// @param info QOI decoding info as a result of decoding the image
+/// @param zoom Zoom mode the image is shown with
+/// @return true if decoding started, false if info contains the error
+static bool begin_still(name_node_pool_t* node, int index, uint8_t* bytes, qoi_img_info_t* info, qoi_zoom_mode zoom) {
+    const qoi_probe_info_t* probe = &node->catalog[index];
+
+    if (is_cropped(probe, zoom)) {
+        return beginQOIRegion(
+            node->name[index],
+            bytes,
+            info,
+            (probe->width - SCREEN_WIDTH) / 2,
+            (probe->height - SCREEN_HEIGHT) / 2,
+            SCREEN_WIDTH,
+            SCREEN_HEIGHT
+        );
+    }
+
+    return beginQOIDecode(node->name[index], bytes, info);
+}
+
+/// @brief Decodes an image or the first frame of an animation into the back slot and puts it on screen
+/// @param node Block of names the image is in
+/// @param index Position of the image in the block
+/// @param anim QOI animation played if the image is one. Any animation playing is closed
+/// @param info QOI info of the image on screen, replaced by the info of the new image if it can be shown
+/// @return true if the image is on screen, false if the image before it stays there
+bool openImage(name_node_pool_t* node, int index, qoi_anim_t* anim, qoi_img_info_t* info) {
+    size_t size = get_image_size(&node->catalog[index], info->zoomMode);
+    bool still = node->catalog[index].frameCount == 0;
+    qoi_img_info_t loaded = *info;
+    uint8_t* bytes;
+
+    closeQOIAnimation(anim);
+
+    bytes = acquire_back_slot(size, still);
+
+    if (!still) {
+        loaded.error = bytes ? openQOIAnimation(node->name[index], anim) : QOI_NULL_BUFFER;
+
+        // the canvas starts out black for frames that do not cover all of it
+        if (loaded.error == QOI_OK) {
+            sys_hw_memset(bytes, 0, size);
+            data_cache_hit_writeback(bytes, size);
+        }
+
+        if (loaded.error == QOI_OK && beginQOIFrame(anim, NULL, bytes, &loaded)) {
+            stepQOIDecode(0);
+        }
+    }
+    else if (begin_still(node, index, bytes, &loaded, info->zoomMode)) {
+        stepQOIDecode(0);
+    }
+
+    // the image on screen stays there if the new one cannot be shown
+    if (loaded.error != QOI_OK) {
+        debugf("Cannot show %s (error %i)\n", node->name[index], loaded.error);
+
+        closeQOIAnimation(anim);
+        release_back_slot();
+
+        return false;
+    }
+
+    swap_slots(info);
+    *info = loaded;
+
+    return true;
+}
+
+/// @brief A still image decoded ahead into the image cache while the image before it is shown
+typedef struct prefetch_job {
+    /// @brief Whether an image is being decoded ahead
+    bool active;
+
+    /// @brief QOI info of the image being decoded ahead
+    qoi_img_info_t info;
+
+    /// @brief Raw image buffer from the image pool the image is decoded into
+    uint8_t* pixels;
+
+    /// @brief Name of the image being decoded ahead
+    const char* name;
+
+    /// @brief Name of the last image that failed to decode ahead so it is not tried again and again
+    const char* failed;
+} prefetch_job_t;
+
+/// @brief Image being decoded ahead
+static prefetch_job_t prefetch = {
+    .active = false,
+    .pixels = NULL,
+    .name = NULL,
+    .failed = NULL
+};
+
+/// @brief Stops decoding an image ahead if one is and gives its raw image buffer back
+static void cancel_prefetch(void) {
+    if (prefetch.active) {
+        cancelQOIDecode();
+        qoi_pool_free(&image_pool, prefetch.pixels);
+
+        prefetch.active = false;
+        prefetch.pixels = NULL;
+    }
+}
+
+/// @brief Decodes the images after the one on screen ahead into the image cache a slice at a time
+/// @details Only call this while nothing else uses the decoder
+/// @param node Block of names the image on screen is in
+/// @param index Position of the image on screen in the block
+/// @param zoom Zoom mode images are shown with
+static void step_prefetch(name_node_pool_t* node, int index, qoi_zoom_mode zoom) {
+    name_node_pool_t* shown_node = node;
+    int shown_index = index;
+
+    // the first image ahead that is not cached yet is decoded next
+    for (int i = 0; i < memory_plan.prefetchDepth && !prefetch.active; i++) {
+        const qoi_probe_info_t* probe;
+
+        next_position(&node, &index);
+        probe = &node->catalog[index];
+
+        if ((node == shown_node && index == shown_index) ||
+            probe->error != QOI_OK ||
+            probe->frameCount > 0 ||
+            node->name[index] == prefetch.failed ||
+            qoi_cache_contains(&image_cache, node->name[index], is_cropped(probe, zoom))
+        ) {
+            continue;
+        }
+
+        // the images on screen and the cached images come first when the pool is full
+        prefetch.pixels = qoi_pool_alloc(&image_pool, get_image_size(probe, zoom));
+
+        if (!prefetch.pixels) {
+            return;
+        }
+
+        prefetch.name = node->name[index];
+        prefetch.active = begin_still(node, index, prefetch.pixels, &prefetch.info, zoom);
+
+        if (!prefetch.active) {
+            prefetch.failed = prefetch.name;
+            qoi_pool_free(&image_pool, prefetch.pixels);
+            prefetch.pixels = NULL;
+        }
+
+        return;
+    }
+
+    if (prefetch.active && stepQOIDecode(TICKS_FROM_US(QOI_DEC_PREFETCH_SLICE_US))) {
+        if (prefetch.info.error == QOI_OK) {
+            qoi_cache_put(&image_cache, &prefetch.info, 0);
+        }
+        else {
+            prefetch.failed = prefetch.name;
+            qoi_pool_free(&image_pool, prefetch.pixels);
+        }
+
+        debugf("Prefetched %s in %f ms (error %i)\n", prefetch.info.name, prefetch.info.decodeTime * 1000.0f, prefetch.info.error);
+
+        prefetch.active = false;
+        prefetch.pixels = NULL;
+    }
+}
+
 /// @brief This function is the entry point for QOI Viewer
 int main(void) {
     
 
     int index = 0, prev_index = 0;
+
+    // slideshow state
+    bool slideshow = QOI_DEC_SLIDESHOW_AT_BOOT;
+    bool decoding_next = false, next_ready = false, in_transition = false, skip_next = false;
+    int next_index = 0;
+    long long shown_at = 0, transition_start = 0, last_frame = 0;
+    long long frame_ticks, dwell_ticks, transition_ticks;
+
+    // state of a still image picked with the controller that is still arriving from the cartridge
+    bool loading = false;
+
+    // browser state
+    static qoi_thumbnail_store_t thumbnails;
+    image_entry_t* images;
+    int image_count = 0, selected = 0, top_row = 0;
+    bool browsing = false, ignore_held = false;
+
+    // animation state
+    qoi_anim_t anim = {.fp = NULL};
+    bool frame_decoding = false, frame_ready = false;
+    int shown_delay_ms = 0;
+    long long frame_shown_at = 0;
+
+    // benchmark state
+    static qoi_bench_t bench;
+    bool benchmark = QOI_DEC_BENCHMARK_AT_BOOT;
+    int bench_move = 0;
+
+    // animation statistics reported every time the animation loops
+    int frames_shown = 0, frames_dropped = 0;
+    float frame_decode_total = 0.0f, frame_decode_max = 0.0f;
     
     name_node_pool_t start_node = (name_node_pool_t) {
         // loop back into itself if there is only one pool sector
@@ -192,14 +724,25 @@ int main(void) {
     };
 
     name_node_pool_t* current_node = &start_node;
+    name_node_pool_t* next_node = &start_node;
     
     qoi_img_info_t info = (qoi_img_info_t) {
         .width = 0,
         .height = 0,
         .channels = 0,
-        .error = QOI_NOT_INITIALIZED
+        .error = QOI_NOT_INITIALIZED,
+        .zoomMode = QOI_DEC_DEFAULT_ZOOM
     };
 
+    // image being decoded ahead by the slideshow
+    qoi_img_info_t next_info = info;
+
+    // next frame of the animation being decoded
+    qoi_img_info_t frame_info = info;
+
+    // image picked with the controller being decoded
+    qoi_img_info_t load_info = info;
+
     // Font for displaying debug text
     rdpq_font_t *font;
 
@@ -207,17 +750,28 @@ int main(void) {
     
     readNames(&start_node);
 
-    sys_hw_memset(buffer0, 0, IMG_BUFFER_SIZE); // clear the buffer
-    
-    openQOIFile(start_node.name[0], &buffer0[0], &info);
+    images = list_images(&start_node, &image_count);
+    qoi_thumbnail_init(&thumbnails);
+
+    arena_report(&viewer_arena, "Viewer");
+
+    // holding L and R while booting runs the benchmark
+    joypad_poll();
+    benchmark |= joypad_get_inputs(JOYPAD_PORT_1).btn.l && joypad_get_inputs(JOYPAD_PORT_1).btn.r;
 
-    assert(info.error == QOI_OK);
+    // oversized and invalid files found by the catalog are skipped
+    if (start_node.catalog[0].error != QOI_OK) {
+        next_position(&current_node, &index);
+        prev_index = index;
+    }
+
+    // images that cannot be read are skipped until one is shown
+    for (int tries = 0; tries < image_count && !openImage(current_node, index, &anim, &info); tries++) {
+        next_position(&current_node, &index);
+        prev_index = index;
+    }
 
-    // somehow double buffering
-    // the image 
-    // fixes black lines at the
-    // bottom of the screen
-    memcpy(buffer1, buffer0, IMG_BUFFER_SIZE);  
+    assertf(info.error == QOI_OK, "No QOI images that can be shown found in ROM.");
 
     printFirstDecodedValues(&info);
     
@@ -233,49 +787,206 @@ int main(void) {
 
     info.renderDebugFont = true;
 
+    frame_ticks = (long long)(TICKS_PER_SECOND / display_get_refresh_rate());
+    dwell_ticks = TICKS_FROM_MS(QOI_DEC_SLIDESHOW_DWELL_MS);
+    transition_ticks = TICKS_FROM_MS(QOI_DEC_SLIDESHOW_TRANSITION_MS);
+    shown_at = timer_ticks();
+    frame_shown_at = shown_at;
+    shown_delay_ms = anim.delayMs;
+
+    if (benchmark && qoi_bench_start(&bench, image_count, frame_ticks)) {
+        slideshow = false;
+    }
+
     while (1) {
         surface_t* disp;
+        long long now;
 
         while(!(disp = display_try_get())) {;}
         joypad_port_t port = JOYPAD_PORT_1;
 
+        now = timer_ticks();
+
+        // a frame taking longer than one and a half refreshes missed a vblank
+        if (slideshow && last_frame != 0 && now - last_frame > frame_ticks * 3 / 2) {
+            debugf("Slideshow frame overrun: %lld us\n", TICKS_TO_US(now - last_frame));
+        }
+
+        last_frame = now;
+
         joypad_inputs_t input = joypad_poll_port(port);
         joypad_buttons_t pressed = joypad_get_buttons_pressed(port);
 
-        // toggle debug text upon pressing these buttons
-        if (pressed.start || pressed.z) {
+        // the benchmark moves through the images on its own and the controller is ignored until it is done
+        if (bench.running) {
+            bench_move = qoi_bench_step(&bench, now, loading);
+
+            memset(&input, 0, sizeof(input));
+            memset(&pressed, 0, sizeof(pressed));
+        }
+
+        // toggle debug text upon pressing start
+        if (pressed.start) {
             toggleDebugText(&info);
         }
 
-        // go to previous image if left is pressed
-        if (
+        // open the browser upon pressing Z
+        if (pressed.z && !browsing) {
+            // the thumbnails take over the decoder while browsing
+            cancel_prefetch();
+            cancelQOIDecode();
+            closeQOIAnimation(&anim);
+            decoding_next = next_ready = in_transition = skip_next = false;
+            frame_decoding = frame_ready = false;
+            loading = false;
+            browsing = true;
+
+            for (int i = 0; i < image_count; i++) {
+                if (images[i].node == current_node && images[i].index == index) {
+                    selected = i;
+                }
+            }
+        }
+        else if (browsing) {
+            const char* wanted[BROWSER_COLUMNS * (BROWSER_ROWS + 2)];
+            const qoi_img_info_t* cells[BROWSER_COLUMNS * BROWSER_ROWS];
+            int first, count = 0, cell_count = 0;
+
+            // move the selection a cell at a time
+            if (pressed.d_left || pressed.c_left || joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_X) == -1) {
+                selected--;
+            }
+
+            if (pressed.d_right || pressed.c_right || joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_X) == 1) {
+                selected++;
+            }
+
+            if (pressed.d_up || pressed.c_up || joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_Y) == 1) {
+                selected -= BROWSER_COLUMNS;
+            }
+
+            if (pressed.d_down || pressed.c_down || joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_Y) == -1) {
+                selected += BROWSER_COLUMNS;
+            }
+
+            selected = selected < 0 ? 0 : selected >= image_count ? image_count - 1 : selected;
+
+            // the page scrolls a row at a time to keep the selection on it
+            if (selected / BROWSER_COLUMNS < top_row) {
+                top_row = selected / BROWSER_COLUMNS;
+            }
+
+            if (selected / BROWSER_COLUMNS >= top_row + BROWSER_ROWS) {
+                top_row = selected / BROWSER_COLUMNS - BROWSER_ROWS + 1;
+            }
+
+            // A shows the selected image, B and Z go back to the image shown before
+            if (pressed.a || pressed.b || pressed.z) {
+                qoi_thumbnail_cancel(&thumbnails);
+
+                if (pressed.a) {
+                    current_node = images[selected].node;
+                    index = images[selected].index;
+                }
+
+                // the image is loaded again since what was playing or loading was stopped
+                prev_index = -1;
+                browsing = false;
+                ignore_held = true;
+            }
+
+            // the page comes first, then the rows below and above it so scrolling finds them made
+            first = top_row * BROWSER_COLUMNS;
+
+            for (int i = first; i < first + BROWSER_COLUMNS * (BROWSER_ROWS + 1) && i < image_count; i++) {
+                wanted[count++] = images[i].node->name[images[i].index];
+            }
+
+            for (int i = first - BROWSER_COLUMNS; i < first; i++) {
+                if (i >= 0) {
+                    wanted[count++] = images[i].node->name[images[i].index];
+                }
+            }
+
+            if (browsing) {
+                qoi_thumbnail_make(&thumbnails, wanted, count, TICKS_FROM_US(QOI_DEC_THUMBNAIL_SLICE_US));
+            }
+
+            for (int i = first; i < first + BROWSER_COLUMNS * BROWSER_ROWS && i < image_count; i++) {
+                qoi_thumbnail_t* thumbnail = qoi_thumbnail_find(&thumbnails, images[i].node->name[images[i].index]);
+
+                cells[cell_count++] = thumbnail ? &thumbnail->info : NULL;
+            }
+
+            // names are shown without the rom:/ in front
+            draw_browser(disp, cells, cell_count, selected - first, images[selected].node->name[images[selected].index] + 5);
+            continue;
+        }
+
+        // switch between zoom modes upon pressing up
+        if (pressed.d_up || pressed.c_up) {
+            cycleZoomMode(&info);
+
+            // a big image is decoded again when 1:1 starts or stops showing the middle of it at full resolution
+            // 1:1 is always left for fit
+            if (!anim.fp &&
+                current_node->catalog[index].downscaleShift > 0 &&
+                (info.zoomMode == QOI_ZOOM_ORIGINAL || info.zoomMode == QOI_ZOOM_FIT)
+            ) {
+                prev_index = -1;
+            }
+        }
+
+        // start or stop the slideshow upon pressing down
+        if (pressed.d_down || pressed.c_down) {
+            slideshow ^= true;
+
+            // the decoder belongs to the animation or the image being loaded while there is one
+            cancel_prefetch();
+
+            if (!anim.fp && !loading) {
+                cancelQOIDecode();
+            }
+
+            decoding_next = next_ready = in_transition = skip_next = false;
+            shown_at = now;
+        }
+
+        bool go_previous = 
             input.btn.b || 
             input.btn.d_left || 
             input.btn.l || 
             input.btn.c_left ||
-            joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_X) == -1
-        ) {
-            index--;
-
-            if (index == -1) {
-                current_node = (name_node_pool_t*)current_node->prev;
-                index = current_node->num_images - 1;
-                assert(index >= 0);
-            }
-        }
+            joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_X) == -1;
 
-        // advance to next image if right is pressed
-        if (
+        bool go_next = 
             input.btn.a || 
             input.btn.d_right || 
             input.btn.r || 
             input.btn.c_right ||
-            joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_X) == 1
-        ) {
-            index++;
-            if (index >= current_node->num_images) {
-                current_node = (name_node_pool_t*)current_node->next;
-                index = 0;
+            joypad_get_axis_pressed(port, JOYPAD_AXIS_STICK_X) == 1;
+
+        // the button that closed the browser does not move on until it is let go
+        if (ignore_held) {
+            ignore_held = go_previous || go_next;
+            go_previous = go_next = false;
+        }
+
+        if (bench.running) {
+            go_previous = bench_move < 0;
+            go_next = bench_move > 0;
+        }
+
+        // a held direction moves on once the image being loaded is on screen
+        if (!loading) {
+            // go to previous image if left is pressed
+            if (go_previous) {
+                previous_position(&current_node, &index);
+            }
+
+            // advance to next image if right is pressed
+            if (go_next) {
+                next_position(&current_node, &index);
             }
         }
 
@@ -283,13 +994,205 @@ int main(void) {
         if (prev_index != index) {
             prev_index = index;
 
-            openQOIFile(current_node->name[index], buffer0, &info);
-            memcpy(buffer1, buffer0, IMG_BUFFER_SIZE);
+            // the slideshow picks up again from the image chosen
+            cancel_prefetch();
+            cancelQOIDecode();
+            decoding_next = next_ready = in_transition = skip_next = false;
+            loading = false;
+
+            if (current_node->catalog[index].frameCount > 0) {
+                // the image on screen stays there if the animation cannot be opened
+                openImage(current_node, index, &anim, &info);
+            }
+            else if (take_cached(current_node->name[index], is_cropped(&current_node->catalog[index], info.zoomMode), &load_info)) {
+                // an image seen or decoded ahead before is shown right away
+                closeQOIAnimation(&anim);
+
+                load_info.renderDebugFont = info.renderDebugFont;
+                load_info.zoomMode = info.zoomMode;
+                swap_slots(&info);
+                info = load_info;
+            }
+            else {
+                // the image on screen stays there and the controller is read while the new one arrives
+                closeQOIAnimation(&anim);
+
+                loading = begin_still(
+                    current_node,
+                    index,
+                    acquire_back_slot(get_image_size(&current_node->catalog[index], info.zoomMode), true),
+                    &load_info,
+                    info.zoomMode
+                );
+
+                // the image on screen stays there and the next press moves on from the one that failed
+                if (!loading) {
+                    debugf("Cannot show %s (error %i)\n", current_node->name[index], load_info.error);
+                    release_back_slot();
+                }
+            }
+
+            if (image_cache.capacity > 0) {
+                qoi_cache_report(&image_cache);
+            }
+
+            shown_at = timer_ticks();
 
-            assert(info.error == QOI_OK);
+            frame_decoding = frame_ready = false;
+            frame_shown_at = shown_at;
+            shown_delay_ms = anim.delayMs;
+            frames_shown = frames_dropped = 0;
+            frame_decode_total = frame_decode_max = 0.0f;
+        }
+
+        if (loading && stepQOIDecode(TICKS_FROM_US(QOI_DEC_LOAD_SLICE_US))) {
+            loading = false;
+
+            if (load_info.error == QOI_OK) {
+                load_info.renderDebugFont = info.renderDebugFont;
+                load_info.zoomMode = info.zoomMode;
+                swap_slots(&info);
+                info = load_info;
+
+                shown_at = now;
+            }
+            else {
+                debugf("Cannot show %s (error %i)\n", current_node->name[index], load_info.error);
+                release_back_slot();
+            }
+        }
+
+        if (anim.fp) {
+            // decode the next frame into the buffer not on screen
+            // a slice at a time while the current frame is shown
+            if (!frame_decoding && !frame_ready) {
+                frame_decoding = beginQOIFrame(&anim, info.pixels, acquire_back_slot(getQOIBufferSize(anim.width, anim.height), false), &frame_info);
+            }
+            else if (frame_decoding && stepQOIDecode(TICKS_FROM_US(QOI_DEC_ANIMATION_SLICE_US))) {
+                frame_decoding = false;
+                frame_ready = frame_info.error == QOI_OK;
+
+                frame_decode_total += frame_info.decodeTime;
+
+                if (frame_info.decodeTime > frame_decode_max) {
+                    frame_decode_max = frame_info.decodeTime;
+                }
+            }
+
+            // the last frame decoded stays on screen if a frame cannot be decoded
+            if (!frame_decoding && !frame_ready) {
+                debugf("Animation %s stopped at frame %i (error %i)\n", anim.name, anim.frame, frame_info.error);
+                closeQOIAnimation(&anim);
+            }
+
+            if (frame_ready && now - frame_shown_at >= TICKS_FROM_MS(shown_delay_ms)) {
+                // every refresh that went by after the frame on screen was due to change is a dropped frame
+                frames_dropped += (now - frame_shown_at - TICKS_FROM_MS(shown_delay_ms)) / frame_ticks;
+                frames_shown++;
+
+                frame_info.renderDebugFont = info.renderDebugFont;
+                frame_info.zoomMode = info.zoomMode;
+                swap_slots(&info);
+                info = frame_info;
+
+                shown_delay_ms = anim.delayMs;
+                frame_shown_at = now;
+                frame_ready = false;
+
+                if (frames_shown >= anim.frameCount) {
+                    debugf(
+                        "Animation %s: %i frames, %i dropped, %f ms average and %f ms worst decode per frame\n",
+                        anim.name,
+                        frames_shown,
+                        frames_dropped,
+                        frame_decode_total * 1000.0f / frames_shown,
+                        frame_decode_max * 1000.0f
+                    );
+
+                    frames_shown = frames_dropped = 0;
+                    frame_decode_total = frame_decode_max = 0.0f;
+                }
+            }
+        }
+        // the slideshow waits while an animation plays or an image is loaded
+        else if (slideshow && !loading) {
+            // decode the next image into the buffer not on screen
+            // a slice at a time while the current image is shown
+            if (!decoding_next && !next_ready) {
+                // images that fail to decode are skipped
+                if (!skip_next) {
+                    next_node = current_node;
+                    next_index = index;
+                }
+
+                next_position(&next_node, &next_index);
+
+                // a cached image is ready to be shown without decoding it
+                next_ready = take_cached(
+                    next_node->name[next_index],
+                    is_cropped(&next_node->catalog[next_index], info.zoomMode),
+                    &next_info
+                );
+
+                decoding_next = !next_ready && begin_still(
+                    next_node,
+                    next_index,
+                    acquire_back_slot(get_image_size(&next_node->catalog[next_index], info.zoomMode), true),
+                    &next_info,
+                    info.zoomMode
+                );
+
+                skip_next = !decoding_next && !next_ready;
+            }
+            else if (decoding_next && stepQOIDecode(TICKS_FROM_US(QOI_DEC_SLIDESHOW_SLICE_US))) {
+                decoding_next = false;
+                next_ready = next_info.error == QOI_OK;
+                skip_next = !next_ready;
+
+                debugf(
+                    "Slideshow decoded %s in %f ms (error %i)\n",
+                    next_node->name[next_index],
+                    next_info.decodeTime * 1000.0f,
+                    next_info.error
+                );
+            }
+
+            if (next_ready && !in_transition && now - shown_at >= dwell_ticks) {
+                in_transition = true;
+                transition_start = now;
+            }
+
+            if (in_transition) {
+                float progress = (float)(now - transition_start) / (float)transition_ticks;
+
+                if (progress < 1.0f) {
+                    draw_transition(disp, &info, &next_info, QOI_DEC_SLIDESHOW_TRANSITION, progress);
+                    mark_slot_drawn(info.pixels);
+                    mark_slot_drawn(next_info.pixels);
+                    continue;
+                }
+
+                // the next image is fully shown so it becomes the current image
+                next_info.renderDebugFont = info.renderDebugFont;
+                next_info.zoomMode = info.zoomMode;
+                swap_slots(&info);
+                info = next_info;
+
+                current_node = next_node;
+                index = prev_index = next_index;
+
+                next_ready = in_transition = false;
+                shown_at = now;
+            }
+        }
+        // the images after the one on screen are decoded ahead while it is looked at
+        else if (!loading && memory_plan.prefetchDepth > 0) {
+            step_prefetch(current_node, index, info.zoomMode);
         }
 
         draw_image(disp, info);
-        
+        mark_slot_drawn(info.pixels);
+
+        qoi_bench_frame_drawn(&bench, current_node->name[index], loading);
     }
 }
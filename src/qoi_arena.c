@@ -0,0 +1,106 @@
+/*
+
+    qoi_arena.c
+
+    This source code implements the arena allocator used by the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2025-2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+
+/// @file qoi_arena.c
+/// @brief This source code implements the arena allocator used by the QOI viewer
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <malloc.h>
+
+#include <libdragon.h>
+
+#include "qoi_arena.h"
+
+/// @brief Arena holding the names of QOI files and the scratch memory for decoding
+qoi_arena_t viewer_arena = {
+    .base = NULL,
+    .size = 0,
+    .used = 0,
+    .highWater = 0
+};
+
+/// @brief Allocates the memory of an arena. Only call this once at boot
+/// @param arena Arena to set up
+/// @param size Size of the arena in bytes
+/// @return true if the memory was allocated
+bool arena_init(qoi_arena_t* arena, size_t size) {
+    // the heap is only touched here so it never fragments afterwards
+    arena->base = (uint8_t*)memalign(ARENA_ALIGNMENT, size);
+    arena->size = arena->base ? size : 0;
+    arena->used = 0;
+    arena->highWater = 0;
+
+    return arena->base != NULL;
+}
+
+/// @brief Hands out memory from an arena
+/// @param arena Arena to allocate from
+/// @param size Size of the allocation in bytes
+/// @return Pointer aligned to ARENA_ALIGNMENT or NULL if the arena is full
+void* arena_alloc(qoi_arena_t* arena, size_t size) {
+    size_t aligned_size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    void* ptr;
+
+    if (aligned_size > arena->size - arena->used) {
+        return NULL;
+    }
+
+    ptr = arena->base + arena->used;
+    arena->used += aligned_size;
+
+    if (arena->used > arena->highWater) {
+        arena->highWater = arena->used;
+    }
+
+    return ptr;
+}
+
+/// @brief Releases everything allocated after a mark from arena_mark()
+/// @param arena Arena to release memory from
+/// @param mark Mark returned by arena_mark()
+void arena_reset(qoi_arena_t* arena, size_t mark) {
+    if (mark < arena->used) {
+        arena->used = mark;
+    }
+}
+
+/// @brief Prints how much of an arena is used over the debug log
+/// @param arena Arena to report on
+/// @param name Name of the arena in the report
+void arena_report(qoi_arena_t* arena, const char* name) {
+    debugf(
+        "%s arena: %u bytes used, %u bytes high water, %u bytes total\n",
+        name,
+        (unsigned int)arena->used,
+        (unsigned int)arena->highWater,
+        (unsigned int)arena->size
+    );
+}
@@ -0,0 +1,98 @@
+/*
+
+    qoi_arena.h
+
+    This header contains declaration of the arena allocator used by the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2025-2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_arena.h
+/// @brief This header contains declaration of the arena allocator used by the QOI viewer
+
+#ifndef QOI_ARENA_H
+#define QOI_ARENA_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// @brief Alignment of every allocation in bytes, matching a data cache line
+#define ARENA_ALIGNMENT 16
+
+/// @brief A block of memory handed out from front to back and released all at once
+typedef struct qoi_arena {
+    /// @brief Start of the memory owned by the arena
+    uint8_t* base;
+
+    /// @brief Size of the memory owned by the arena in bytes
+    size_t size;
+
+    /// @brief Bytes handed out so far
+    size_t used;
+
+    /// @brief Most bytes ever handed out at the same time
+    size_t highWater;
+} qoi_arena_t;
+
+/// @brief Arena holding the names of QOI files and the scratch memory for decoding
+extern qoi_arena_t viewer_arena;
+
+/// @brief Allocates the memory of an arena. Only call this once at boot
+/// @param arena Arena to set up
+/// @param size Size of the arena in bytes
+/// @return true if the memory was allocated
+bool arena_init(qoi_arena_t* arena, size_t size);
+
+/// @brief Hands out memory from an arena
+/// @param arena Arena to allocate from
+/// @param size Size of the allocation in bytes
+/// @return Pointer aligned to ARENA_ALIGNMENT or NULL if the arena is full
+void* arena_alloc(qoi_arena_t* arena, size_t size);
+
+/// @brief Releases everything allocated after a mark from arena_mark()
+/// @param arena Arena to release memory from
+/// @param mark Mark returned by arena_mark()
+void arena_reset(qoi_arena_t* arena, size_t mark);
+
+/// @brief Prints how much of an arena is used over the debug log
+/// @param arena Arena to report on
+/// @param name Name of the arena in the report
+void arena_report(qoi_arena_t* arena, const char* name);
+
+/// @brief Gets a mark to release memory allocated after this point with arena_reset()
+/// @param arena Arena to get the mark of
+/// @return Mark of the arena
+inline size_t arena_mark(qoi_arena_t* arena) {
+    return arena->used;
+}
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_ARENA_H
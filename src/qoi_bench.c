@@ -0,0 +1,276 @@
+/*
+
+    qoi_bench.c
+
+    This source code implements the navigation benchmark of the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_bench.c
+/// @brief This source code implements the navigation benchmark of the QOI viewer
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libdragon.h>
+
+#include "qoi_bench.h"
+#include "qoi_arena.h"
+
+/// @brief Orders latencies for qsort()
+static int compare_ticks(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+
+    return (x > y) - (x < y);
+}
+
+/// @brief Orders frame times for qsort()
+static int compare_frame_ticks(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/// @brief Converts ticks to milliseconds for printing
+/// @param ticks Ticks to convert
+/// @return Milliseconds
+static float ticks_to_ms(long long ticks) {
+    return (float)TICKS_TO_US(ticks) / 1000.0f;
+}
+
+/// @brief Starts the benchmark going forward through every image and back again
+/// @details The switches and frame times are recorded in the viewer arena so only start it while nothing is being decoded
+/// @param bench Benchmark to start
+/// @param image_count Number of images that can be shown
+/// @param refresh_ticks Ticks of one refresh of the display
+/// @return true if the benchmark started
+bool qoi_bench_start(qoi_bench_t* bench, int image_count, long long refresh_ticks) {
+    memset(bench, 0, sizeof(qoi_bench_t));
+
+    if (image_count <= 0) {
+        return false;
+    }
+
+    bench->total = image_count * 2;
+    bench->switches = (qoi_bench_switch_t*)arena_alloc(&viewer_arena, bench->total * sizeof(qoi_bench_switch_t));
+    bench->sorted = (long long*)arena_alloc(&viewer_arena, image_count * sizeof(long long));
+    bench->frameCapacity = bench->total * (QOI_DEC_BENCHMARK_DWELL_FRAMES + QOI_BENCH_LOAD_FRAMES);
+    bench->frameTicks = (uint32_t*)arena_alloc(&viewer_arena, bench->frameCapacity * sizeof(uint32_t));
+
+    if (!bench->switches || !bench->sorted || !bench->frameTicks) {
+        return false;
+    }
+
+    bench->dwell = QOI_DEC_BENCHMARK_DWELL_FRAMES;
+    bench->refreshTicks = refresh_ticks;
+    bench->running = true;
+
+    debugf("Benchmark: %d switches over %d images\n", bench->total, image_count);
+
+    return true;
+}
+
+/// @brief Times a frame and decides where the benchmark goes. Call this at the start of every frame
+/// @param bench Benchmark running
+/// @param now Ticks the frame started at
+/// @param busy Whether the image switched to last is still being loaded
+/// @return 1 to go to the next image, -1 to go to the previous image or 0 to stay
+int qoi_bench_step(qoi_bench_t* bench, long long now, bool busy) {
+    if (!bench->running) {
+        return 0;
+    }
+
+    if (bench->lastFrame != 0) {
+        long long ticks = now - bench->lastFrame;
+        long long refreshes = (ticks + bench->refreshTicks / 2) / bench->refreshTicks;
+
+        bench->frameMin = bench->frameCount == 0 || ticks < bench->frameMin ? ticks : bench->frameMin;
+        bench->frameMax = ticks > bench->frameMax ? ticks : bench->frameMax;
+        bench->frameTotal += ticks;
+
+        if (bench->frameCount < bench->frameCapacity) {
+            bench->frameTicks[bench->frameCount] = (uint32_t)ticks;
+        }
+
+        bench->frameCount++;
+
+        // a frame shorter than half a refresh still waited for one
+        refreshes = refreshes < 1 ? 1 : refreshes > QOI_BENCH_MAX_REFRESHES ? QOI_BENCH_MAX_REFRESHES : refreshes;
+        bench->refreshBuckets[refreshes - 1]++;
+    }
+
+    bench->lastFrame = now;
+
+    // the next switch waits for the image before it to be on screen for the whole dwell
+    if (bench->pending || busy || bench->done >= bench->total || --bench->dwell > 0) {
+        return 0;
+    }
+
+    bench->pending = true;
+    bench->pressedAt = now;
+    bench->switches[bench->done] = (qoi_bench_switch_t){
+        .name = NULL,
+        .forward = bench->done < bench->total / 2,
+        .latency = 0,
+        .frames = 0
+    };
+
+    return bench->switches[bench->done].forward ? 1 : -1;
+}
+
+/// @brief Ends the switch in progress once its image is on screen. Call this after every frame is drawn
+/// @details The summary is printed and the benchmark stops after the last switch
+/// @param bench Benchmark running
+/// @param name Name of the image on screen
+/// @param busy Whether the image switched to last is still being loaded
+void qoi_bench_frame_drawn(qoi_bench_t* bench, const char* name, bool busy) {
+    qoi_bench_switch_t* current;
+
+    if (!bench->running || !bench->pending) {
+        return;
+    }
+
+    current = &bench->switches[bench->done];
+    current->frames++;
+
+    // the image picked is on screen in the first frame drawn after it stops loading
+    if (busy) {
+        return;
+    }
+
+    current->name = name;
+    current->latency = timer_ticks() - bench->pressedAt;
+
+    bench->pending = false;
+    bench->dwell = QOI_DEC_BENCHMARK_DWELL_FRAMES;
+
+    if (++bench->done >= bench->total) {
+        qoi_bench_report(bench);
+        bench->running = false;
+    }
+}
+
+/// @brief Prints the summary of the switches in one direction
+/// @param bench Benchmark to report on
+/// @param forward Whether to sum up the switches to the next image instead of the previous one
+static void report_direction(const qoi_bench_t* bench, bool forward) {
+    long long total = 0;
+    int count = 0;
+
+    for (int i = 0; i < bench->done; i++) {
+        if (bench->switches[i].forward == forward) {
+            bench->sorted[count++] = bench->switches[i].latency;
+            total += bench->switches[i].latency;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    qsort(bench->sorted, count, sizeof(long long), compare_ticks);
+
+    debugf(
+        "%-8s %5d %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+        forward ? "next" : "previous",
+        count,
+        ticks_to_ms(bench->sorted[0]),
+        ticks_to_ms(total / count),
+        ticks_to_ms(bench->sorted[count / 2]),
+        ticks_to_ms(bench->sorted[(count * 95) / 100]),
+        ticks_to_ms(bench->sorted[count - 1])
+    );
+}
+
+/// @brief Gets the frame time a share of the frames timed took at most
+/// @param sorted Ticks of the frames sorted from shortest to longest
+/// @param count Number of frames
+/// @param percent Share of the frames in percent
+/// @return Ticks of the frame at that rank
+static uint32_t get_frame_percentile(const uint32_t* sorted, int count, int percent) {
+    int rank = (count * percent + 99) / 100;
+
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/// @brief Prints every switch and the summary of the benchmark over the debug log
+/// @param bench Benchmark to report on
+void qoi_bench_report(const qoi_bench_t* bench) {
+    debugf("Benchmark switches:\n");
+    debugf("%5s %-8s %10s %6s  %s\n", "#", "to", "ms", "frames", "image");
+
+    for (int i = 0; i < bench->done; i++) {
+        const qoi_bench_switch_t* entry = &bench->switches[i];
+
+        debugf(
+            "%5d %-8s %10.3f %6d  %s\n",
+            i + 1,
+            entry->forward ? "next" : "previous",
+            ticks_to_ms(entry->latency),
+            entry->frames,
+            entry->name ? entry->name : "?"
+        );
+    }
+
+    debugf("Benchmark switch latency in ms from the button press to the first frame showing the image:\n");
+    debugf("%-8s %5s %9s %9s %9s %9s %9s\n", "to", "count", "min", "average", "median", "p95", "max");
+    report_direction(bench, true);
+    report_direction(bench, false);
+
+    if (bench->frameCount == 0) {
+        return;
+    }
+
+    int stored = bench->frameCount < bench->frameCapacity ? bench->frameCount : bench->frameCapacity;
+
+    qsort(bench->frameTicks, stored, sizeof(uint32_t), compare_frame_ticks);
+
+    debugf(
+        "Benchmark frame time in ms: %d frames, %.3f min, %.3f average, %.3f p50, %.3f p95, %.3f p99, %.3f max\n",
+        bench->frameCount,
+        ticks_to_ms(bench->frameMin),
+        ticks_to_ms(bench->frameTotal / bench->frameCount),
+        ticks_to_ms(get_frame_percentile(bench->frameTicks, stored, 50)),
+        ticks_to_ms(get_frame_percentile(bench->frameTicks, stored, 95)),
+        ticks_to_ms(get_frame_percentile(bench->frameTicks, stored, 99)),
+        ticks_to_ms(bench->frameMax)
+    );
+
+    if (stored < bench->frameCount) {
+        debugf("Benchmark frame time percentiles are of the first %d frames\n", stored);
+    }
+
+    for (int i = 0; i < QOI_BENCH_MAX_REFRESHES; i++) {
+        debugf(
+            "Benchmark frames taking %d refresh%s: %d (%.1f%%)\n",
+            i + 1,
+            i == QOI_BENCH_MAX_REFRESHES - 1 ? "es or more" : i > 0 ? "es" : "",
+            bench->refreshBuckets[i],
+            bench->refreshBuckets[i] * 100.0f / bench->frameCount
+        );
+    }
+}
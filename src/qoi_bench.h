@@ -0,0 +1,151 @@
+/*
+
+    qoi_bench.h
+
+    This header contains declaration of the navigation benchmark of the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_bench.h
+/// @brief This header contains declaration of the navigation benchmark of the QOI viewer
+
+#ifndef QOI_BENCH_H
+#define QOI_BENCH_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/// @brief Frames set aside per switch for loading the image on top of the dwell. Frames past the room set aside are not in the percentiles
+#define QOI_BENCH_LOAD_FRAMES 60
+
+/// @brief Most refreshes a frame is counted as taking in the summary. Longer frames count as this many
+#define QOI_BENCH_MAX_REFRESHES 4
+
+/// @brief A switch from one image to another made by the benchmark
+typedef struct qoi_bench_switch {
+    /// @brief Name of the image switched to
+    const char* name;
+
+    /// @brief Whether the benchmark moved to the next image instead of the previous one
+    bool forward;
+
+    /// @brief Ticks from the frame the button was pressed on to the first frame showing the image
+    long long latency;
+
+    /// @brief Frames from the frame the button was pressed on to the first frame showing the image
+    int frames;
+} qoi_bench_switch_t;
+
+/// @brief State of the navigation benchmark
+typedef struct qoi_bench {
+    /// @brief Whether the benchmark is driving the viewer
+    bool running;
+
+    /// @brief Switches the benchmark makes, one forward and one back for every image
+    qoi_bench_switch_t* switches;
+
+    /// @brief Latencies of the switches in one direction, sorted when the summary is printed
+    long long* sorted;
+
+    /// @brief Number of switches the benchmark makes
+    int total;
+
+    /// @brief Number of switches finished
+    int done;
+
+    /// @brief Frames left until the next switch
+    int dwell;
+
+    /// @brief Whether a switch was started and the image is not on screen yet
+    bool pending;
+
+    /// @brief Ticks of the frame the switch in progress was started on
+    long long pressedAt;
+
+    /// @brief Ticks of one refresh of the display
+    long long refreshTicks;
+
+    /// @brief Ticks the frame before started or 0 before the first frame
+    long long lastFrame;
+
+    /// @brief Number of frames timed
+    int frameCount;
+
+    /// @brief Ticks of every frame timed together
+    long long frameTotal;
+
+    /// @brief Ticks of the shortest frame
+    long long frameMin;
+
+    /// @brief Ticks of the longest frame
+    long long frameMax;
+
+    /// @brief Ticks of each frame timed, sorted when the summary is printed
+    uint32_t* frameTicks;
+
+    /// @brief Most frames frameTicks has room for
+    int frameCapacity;
+
+    /// @brief Number of frames taking each number of refreshes, from one refresh up
+    int refreshBuckets[QOI_BENCH_MAX_REFRESHES];
+} qoi_bench_t;
+
+/// @brief Starts the benchmark going forward through every image and back again
+/// @details The switches and frame times are recorded in the viewer arena so only start it while nothing is being decoded
+/// @param bench Benchmark to start
+/// @param image_count Number of images that can be shown
+/// @param refresh_ticks Ticks of one refresh of the display
+/// @return true if the benchmark started
+bool qoi_bench_start(qoi_bench_t* bench, int image_count, long long refresh_ticks);
+
+/// @brief Times a frame and decides where the benchmark goes. Call this at the start of every frame
+/// @param bench Benchmark running
+/// @param now Ticks the frame started at
+/// @param busy Whether the image switched to last is still being loaded
+/// @return 1 to go to the next image, -1 to go to the previous image or 0 to stay
+int qoi_bench_step(qoi_bench_t* bench, long long now, bool busy);
+
+/// @brief Ends the switch in progress once its image is on screen. Call this after every frame is drawn
+/// @details The summary is printed and the benchmark stops after the last switch
+/// @param bench Benchmark running
+/// @param name Name of the image on screen
+/// @param busy Whether the image switched to last is still being loaded
+void qoi_bench_frame_drawn(qoi_bench_t* bench, const char* name, bool busy);
+
+/// @brief Prints every switch and the summary of the benchmark over the debug log
+/// @param bench Benchmark to report on
+void qoi_bench_report(const qoi_bench_t* bench);
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_BENCH_H
@@ -0,0 +1,209 @@
+/*
+
+    qoi_cache.c
+
+    This source code implements the cache of decoded images used by the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_cache.c
+/// @brief This source code implements the cache of decoded images used by the QOI viewer
+
+#include <stdint.h>
+#include <string.h>
+
+#include <libdragon.h>
+
+#include "qoi_cache.h"
+#include "qoi_pool.h"
+
+/// @brief Cache of the still images the viewer showed or decoded ahead
+qoi_image_cache_t image_cache = {
+    .capacity = 0,
+    .clock = 0,
+    .hits = 0,
+    .misses = 0
+};
+
+/// @brief Finds an image in a cache
+/// @param cache Cache to look in
+/// @param name Name of the QOI file
+/// @param cropped Whether the image is wanted cropped
+/// @return Index of the entry or -1 if the image is not in the cache
+static int find_image(const qoi_image_cache_t* cache, const char* name, bool cropped) {
+    for (int i = 0; i < cache->capacity; i++) {
+        const qoi_cached_image_t* image = &cache->images[i];
+
+        if (image->info.pixels && image->cropped == cropped && strncmp(image->info.name, name, sizeof(image->info.name)) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/// @brief Finds an entry of a cache not holding an image
+/// @param cache Cache to look in
+/// @return Empty entry or NULL if the cache is full
+static qoi_cached_image_t* find_empty(qoi_image_cache_t* cache) {
+    for (int i = 0; i < cache->capacity; i++) {
+        if (!cache->images[i].info.pixels) {
+            return &cache->images[i];
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief Empties a cache
+/// @param cache Cache to set up
+/// @param capacity Number of images kept at most. 0 keeps none
+void qoi_cache_init(qoi_image_cache_t* cache, int capacity) {
+    memset(cache, 0, sizeof(qoi_image_cache_t));
+
+    cache->capacity = capacity < QOI_DEC_MAX_CACHED_IMAGES ? capacity : QOI_DEC_MAX_CACHED_IMAGES;
+}
+
+/// @brief Checks if only the middle of a bigger image was decoded
+/// @param info QOI info of the decoded image
+/// @return true if the image was cropped instead of downscaled
+bool qoi_cache_is_cropped(const qoi_img_info_t* info) {
+    return info->downscaleShift == 0 && (info->width < info->srcWidth || info->height < info->srcHeight);
+}
+
+/// @brief Checks if an image is in a cache without taking it out
+/// @param cache Cache to look in
+/// @param name Name of the QOI file
+/// @param cropped Whether the image is wanted cropped
+/// @return true if the image is in the cache
+bool qoi_cache_contains(const qoi_image_cache_t* cache, const char* name, bool cropped) {
+    return find_image(cache, name, cropped) >= 0;
+}
+
+/// @brief Takes a decoded image out of a cache. The raw image buffer belongs to the caller afterwards
+/// @param cache Cache to look in
+/// @param name Name of the QOI file
+/// @param cropped Whether the image is wanted cropped
+/// @param info QOI info of the image if it is found
+/// @param last_drawn Syncpoint after the last frame that drew the image if it is found
+/// @return true if the image was found
+bool qoi_cache_take(qoi_image_cache_t* cache, const char* name, bool cropped, qoi_img_info_t* info, rspq_syncpoint_t* last_drawn) {
+    int found = find_image(cache, name, cropped);
+
+    if (found < 0) {
+        cache->misses += cache->capacity > 0;
+        return false;
+    }
+
+    *info = cache->images[found].info;
+    *last_drawn = cache->images[found].lastDrawn;
+
+    cache->images[found].info.pixels = NULL;
+    cache->hits++;
+
+    return true;
+}
+
+/// @brief Puts a decoded image in a cache, dropping the least recently used image if it is full
+/// @details The cache owns the raw image buffer afterwards. It goes back to the image pool right away if the cache keeps no images
+/// @param cache Cache to put the image in
+/// @param info QOI info of the image
+/// @param last_drawn Syncpoint after the last frame that drew the image. 0 if none did
+void qoi_cache_put(qoi_image_cache_t* cache, const qoi_img_info_t* info, rspq_syncpoint_t last_drawn) {
+    bool cropped = qoi_cache_is_cropped(info);
+    int slot = find_image(cache, info->name, cropped);
+
+    if (cache->capacity == 0) {
+        rspq_syncpoint_wait(last_drawn);
+        qoi_pool_free(&image_pool, info->pixels);
+        return;
+    }
+
+    // an older copy of the same image is replaced
+    if (slot >= 0) {
+        rspq_syncpoint_wait(cache->images[slot].lastDrawn);
+        qoi_pool_free(&image_pool, cache->images[slot].info.pixels);
+        cache->images[slot].info.pixels = NULL;
+    }
+
+    // a full cache makes room by dropping the image left longest ago
+    if (slot < 0 && !find_empty(cache)) {
+        qoi_cache_evict(cache);
+    }
+
+    if (slot < 0) {
+        slot = (int)(find_empty(cache) - cache->images);
+    }
+
+    cache->images[slot] = (qoi_cached_image_t){
+        .info = *info,
+        .cropped = cropped,
+        .lastDrawn = last_drawn,
+        .lastUsed = ++cache->clock
+    };
+}
+
+/// @brief Drops the least recently used image of a cache and gives its raw image buffer back to the image pool
+/// @param cache Cache to drop an image from
+/// @return false if the cache is empty
+bool qoi_cache_evict(qoi_image_cache_t* cache) {
+    qoi_cached_image_t* oldest = NULL;
+
+    for (int i = 0; i < cache->capacity; i++) {
+        qoi_cached_image_t* image = &cache->images[i];
+
+        if (image->info.pixels && (!oldest || image->lastUsed < oldest->lastUsed)) {
+            oldest = image;
+        }
+    }
+
+    if (!oldest) {
+        return false;
+    }
+
+    // the pool may hand the buffer out again right away so the RDP has to be done reading it
+    rspq_syncpoint_wait(oldest->lastDrawn);
+    qoi_pool_free(&image_pool, oldest->info.pixels);
+    oldest->info.pixels = NULL;
+
+    return true;
+}
+
+/// @brief Prints what a cache holds over the debug log
+/// @param cache Cache to report on
+void qoi_cache_report(const qoi_image_cache_t* cache) {
+    int count = 0;
+
+    for (int i = 0; i < cache->capacity; i++) {
+        count += cache->images[i].info.pixels != NULL;
+    }
+
+    debugf(
+        "Image cache: %d of %d images, %d hits, %d misses\n",
+        count,
+        cache->capacity,
+        cache->hits,
+        cache->misses
+    );
+}
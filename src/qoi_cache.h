@@ -0,0 +1,131 @@
+/*
+
+    qoi_cache.h
+
+    This header contains declaration of the cache of decoded images used by the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_cache.h
+/// @brief This header contains declaration of the cache of decoded images used by the QOI viewer
+
+#ifndef QOI_CACHE_H
+#define QOI_CACHE_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <libdragon.h>
+
+#include "config.h"
+#include "qoi_viewer.h"
+
+/// @brief A decoded image kept in the cache
+typedef struct qoi_cached_image {
+    /// @brief QOI info of the image. The raw image buffer comes from the image pool and is NULL if the entry is empty
+    qoi_img_info_t info;
+
+    /// @brief Whether only the middle of a bigger image was decoded at full resolution
+    bool cropped;
+
+    /// @brief Syncpoint after the last frame that drew the image. 0 if none did
+    rspq_syncpoint_t lastDrawn;
+
+    /// @brief Value of the cache clock when the image was last put in the cache
+    uint32_t lastUsed;
+} qoi_cached_image_t;
+
+/// @brief Decoded images kept after they leave the screen, dropping the least recently used when full
+typedef struct qoi_image_cache {
+    /// @brief Entries of the cache
+    qoi_cached_image_t images[QOI_DEC_MAX_CACHED_IMAGES];
+
+    /// @brief Number of entries in use at most
+    int capacity;
+
+    /// @brief Counts up every time an image is put in the cache
+    uint32_t clock;
+
+    /// @brief Number of images found in the cache
+    int hits;
+
+    /// @brief Number of images looked for and not found in the cache
+    int misses;
+} qoi_image_cache_t;
+
+/// @brief Cache of the still images the viewer showed or decoded ahead
+extern qoi_image_cache_t image_cache;
+
+/// @brief Empties a cache
+/// @param cache Cache to set up
+/// @param capacity Number of images kept at most. 0 keeps none
+void qoi_cache_init(qoi_image_cache_t* cache, int capacity);
+
+/// @brief Checks if only the middle of a bigger image was decoded
+/// @param info QOI info of the decoded image
+/// @return true if the image was cropped instead of downscaled
+bool qoi_cache_is_cropped(const qoi_img_info_t* info);
+
+/// @brief Checks if an image is in a cache without taking it out
+/// @param cache Cache to look in
+/// @param name Name of the QOI file
+/// @param cropped Whether the image is wanted cropped
+/// @return true if the image is in the cache
+bool qoi_cache_contains(const qoi_image_cache_t* cache, const char* name, bool cropped);
+
+/// @brief Takes a decoded image out of a cache. The raw image buffer belongs to the caller afterwards
+/// @param cache Cache to look in
+/// @param name Name of the QOI file
+/// @param cropped Whether the image is wanted cropped
+/// @param info QOI info of the image if it is found
+/// @param last_drawn Syncpoint after the last frame that drew the image if it is found
+/// @return true if the image was found
+bool qoi_cache_take(qoi_image_cache_t* cache, const char* name, bool cropped, qoi_img_info_t* info, rspq_syncpoint_t* last_drawn);
+
+/// @brief Puts a decoded image in a cache, dropping the least recently used image if it is full
+/// @details The cache owns the raw image buffer afterwards. It goes back to the image pool right away if the cache keeps no images
+/// @param cache Cache to put the image in
+/// @param info QOI info of the image
+/// @param last_drawn Syncpoint after the last frame that drew the image. 0 if none did
+void qoi_cache_put(qoi_image_cache_t* cache, const qoi_img_info_t* info, rspq_syncpoint_t last_drawn);
+
+/// @brief Drops the least recently used image of a cache and gives its raw image buffer back to the image pool
+/// @param cache Cache to drop an image from
+/// @return false if the cache is empty
+bool qoi_cache_evict(qoi_image_cache_t* cache);
+
+/// @brief Prints what a cache holds over the debug log
+/// @param cache Cache to report on
+void qoi_cache_report(const qoi_image_cache_t* cache);
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_CACHE_H
@@ -0,0 +1,127 @@
+/*
+
+    qoi_load.c
+
+    This source code implements the loader that reads files from the cartridge with PI DMA
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_load.c
+/// @brief This source code implements the loader that reads files from the cartridge with PI DMA
+
+#include <string.h>
+
+#include <libdragon.h>
+
+#include "qoi_load.h"
+
+/// @brief Prefix of the paths of the ROM filesystem
+#define ROM_PREFIX "rom:/"
+
+extern inline bool qoi_load_active(const qoi_load_t* load);
+
+/// @brief Starts the transfer of the next chunk of a load
+/// @param load Load with bytes left to transfer
+static void start_transfer(qoi_load_t* load) {
+    size_t size = load->remaining < load->chunkSize ? load->remaining : load->chunkSize;
+
+    // the PI moves an even number of bytes so an odd last chunk lands one byte past the file
+    size_t padded = (size + 1) & ~(size_t)1;
+
+    // the PI writes to RDRAM behind the data cache, so lines of the chunk must neither
+    // be read from the cache afterwards nor be written back over it later
+    data_cache_hit_writeback_invalidate(load->dest, padded);
+
+    // the PI takes one transfer at a time and someone else may have started one
+    dma_wait();
+    dma_read_raw_async(load->dest, load->romAddress, padded);
+
+    load->inFlight = size;
+}
+
+uint32_t qoi_load_find(const char* filename) {
+    uint32_t address;
+
+    if (strncmp(filename, ROM_PREFIX, strlen(ROM_PREFIX)) == 0) {
+        filename += strlen(ROM_PREFIX);
+    }
+
+    address = dfs_rom_addr(filename);
+
+    // the PI can only transfer from even cartridge addresses
+    return (address & 1) ? 0 : address;
+}
+
+void qoi_load_begin(qoi_load_t* load, uint32_t rom_address, void* dest, size_t size, size_t chunk_size, qoi_load_callback_t callback, void* user) {
+    load->romAddress = rom_address;
+    load->dest = (uint8_t*)dest;
+    load->remaining = size;
+    load->inFlight = 0;
+    load->chunkSize = chunk_size & ~(size_t)1;
+    load->callback = callback;
+    load->user = user;
+
+    if (load->remaining > 0) {
+        start_transfer(load);
+    }
+}
+
+bool qoi_load_poll(qoi_load_t* load) {
+    if (load->inFlight > 0 && !dma_busy()) {
+        uint8_t* data = load->dest;
+        size_t size = load->inFlight;
+
+        load->romAddress += size;
+        load->dest += size;
+        load->remaining -= size;
+        load->inFlight = 0;
+
+        // the next chunk is on its way before the callback runs so the PI is never idle
+        if (load->remaining > 0) {
+            start_transfer(load);
+        }
+
+        load->callback(load->user, data, size);
+    }
+
+    return qoi_load_active(load);
+}
+
+void qoi_load_wait(qoi_load_t* load) {
+    if (load->inFlight > 0) {
+        dma_wait();
+    }
+
+    qoi_load_poll(load);
+}
+
+void qoi_load_cancel(qoi_load_t* load) {
+    // the PI keeps writing into the memory until the chunk in flight has landed
+    if (load->inFlight > 0) {
+        dma_wait();
+    }
+
+    load->remaining = 0;
+    load->inFlight = 0;
+}
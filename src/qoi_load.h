@@ -0,0 +1,113 @@
+/*
+
+    qoi_load.h
+
+    This header contains declaration of the loader that reads files from the cartridge with PI DMA
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_load.h
+/// @brief This header contains declaration of the loader that reads files from the cartridge with PI DMA
+
+#ifndef QOI_LOAD_H
+#define QOI_LOAD_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// @brief Called each time a chunk of a file has landed in memory
+/// @param user Pointer given to qoi_load_begin()
+/// @param data First byte of the chunk
+/// @param size Size of the chunk in bytes
+typedef void (*qoi_load_callback_t)(void* user, uint8_t* data, size_t size);
+
+/// @brief A file moving from the cartridge to memory one chunk at a time while the CPU does other work
+typedef struct qoi_load {
+    /// @brief Cartridge address of the next chunk
+    uint32_t romAddress;
+
+    /// @brief Where the next chunk lands
+    uint8_t* dest;
+
+    /// @brief Bytes that have not landed yet, including the chunk in flight
+    size_t remaining;
+
+    /// @brief Size of the chunk in flight or 0 if none is
+    size_t inFlight;
+
+    /// @brief Bytes moved by each transfer. Even so every transfer starts on an even cartridge address
+    size_t chunkSize;
+
+    /// @brief Function called as each chunk lands
+    qoi_load_callback_t callback;
+
+    /// @brief Pointer handed to the callback
+    void* user;
+} qoi_load_t;
+
+/// @brief Finds where a file of the ROM filesystem is on the cartridge
+/// @param filename Name of the file with or without the rom:/ prefix
+/// @return Cartridge address of the file or 0 if it cannot be read with PI DMA
+uint32_t qoi_load_find(const char* filename);
+
+/// @brief Starts moving a file from the cartridge to memory and returns without waiting for it
+/// @param load Load to start. Must not have a transfer in flight
+/// @param rom_address Cartridge address from qoi_load_find()
+/// @param dest Memory the file lands in. Aligned to 8 bytes with room for one byte past the end of the file
+/// @param size Size of the file in bytes
+/// @param chunk_size Bytes moved by each transfer. Rounded down to an even number
+/// @param callback Function called as each chunk lands
+/// @param user Pointer handed to the callback
+void qoi_load_begin(qoi_load_t* load, uint32_t rom_address, void* dest, size_t size, size_t chunk_size, qoi_load_callback_t callback, void* user);
+
+/// @brief Hands a chunk that has landed to the callback and starts the transfer of the next one
+/// @param load Load to check on
+/// @return true while the file has not fully landed
+bool qoi_load_poll(qoi_load_t* load);
+
+/// @brief Waits for the chunk in flight to land and hands it to the callback
+/// @param load Load to wait for
+void qoi_load_wait(qoi_load_t* load);
+
+/// @brief Stops a load once the chunk in flight has landed so its memory can be used again
+/// @param load Load to stop
+void qoi_load_cancel(qoi_load_t* load);
+
+/// @brief Checks if a load still has chunks to land
+/// @param load Load to check
+/// @return true while the file has not fully landed
+inline bool qoi_load_active(const qoi_load_t* load) {
+    return load->remaining > 0;
+}
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_LOAD_H
@@ -0,0 +1,175 @@
+/*
+
+    qoi_lz.c
+
+    This source code implements the LZ decompressor for QOI files wrapped in a QOI-LZ container
+
+    Code licensed under MIT License
+
+    Copyright (c) 2025-2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_lz.c
+/// @brief This source code implements the LZ decompressor for QOI files wrapped in a QOI-LZ container
+
+#include <stdint.h>
+#include <string.h>
+
+#include "qoi_lz.h"
+
+/// @brief QOI-LZ magic number
+static const uint8_t QOI_LZ_MAGIC[4] = {'q', 'o', 'i', 'z'};
+
+/// @brief Smallest match of the LZ4 block format
+#define QOI_LZ_MIN_MATCH 4
+
+/// @brief Reads a big endian 32 bit value
+/// @param data Pointer to the first byte
+/// @return Value in native byte order
+static uint32_t read_be32(const uint8_t* data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+/// @brief Reads a length of the LZ4 block format that continues into extra bytes
+/// @param ip Read position in the block. Moved past the extra bytes
+/// @param end End of the block
+/// @param length Length from the token. The extra bytes are added to it
+/// @return false if the block ends in the middle of the length
+static bool read_length(const uint8_t** ip, const uint8_t* end, uint32_t* length) {
+    uint8_t extra;
+
+    do {
+        if (*ip >= end) {
+            return false;
+        }
+
+        extra = *(*ip)++;
+        *length += extra;
+    } while (extra == 255);
+
+    return true;
+}
+
+/// @brief Checks for a QOI-LZ file and reads its header
+/// @param data First QOI_LZ_HEADER_SIZE bytes of the file
+/// @param size Size of the wrapped file in bytes
+/// @return true if the file is a QOI-LZ file
+bool qoi_lz_read_header(const uint8_t* data, uint32_t* size) {
+    if (memcmp(data, QOI_LZ_MAGIC, 4) != 0) {
+        return false;
+    }
+
+    *size = read_be32(&data[4]);
+
+    return true;
+}
+
+/// @brief Reads the header in front of a block
+/// @param data QOI_LZ_BLOCK_HEADER_SIZE bytes of the block header
+/// @param packed_size Bytes stored for the block
+/// @param size Bytes the block decompresses to
+/// @return true if the block fits the limits of the format
+bool qoi_lz_read_block_header(const uint8_t* data, uint32_t* packed_size, uint32_t* size) {
+    *packed_size = read_be32(&data[0]);
+    *size = read_be32(&data[4]);
+
+    return *size <= QOI_LZ_BLOCK_SIZE && *packed_size <= *size;
+}
+
+/// @brief Decompresses a block right after the blocks before it
+/// @param src Bytes stored for the block
+/// @param packed_size Bytes stored for the block
+/// @param dst Where the block decompresses to. Earlier blocks are right in front of it
+/// @param size Bytes the block decompresses to
+/// @param window Start of the wrapped file. Matches cannot reach in front of it
+/// @return true if the block decompressed to exactly size bytes
+bool qoi_lz_decompress_block(const uint8_t* src, uint32_t packed_size, uint8_t* dst, uint32_t size, const uint8_t* window) {
+    const uint8_t* ip = src;
+    const uint8_t* ip_end = src + packed_size;
+    uint8_t* op = dst;
+    uint8_t* op_end = dst + size;
+
+    // blocks that did not get smaller are stored as is
+    if (packed_size == size) {
+        memcpy(dst, src, size);
+        return true;
+    }
+
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+        uint32_t length = token >> 4;
+        uint32_t offset;
+        const uint8_t* match;
+
+        if (length == 15 && !read_length(&ip, ip_end, &length)) {
+            return false;
+        }
+
+        if (length > (uint32_t)(ip_end - ip) || length > (uint32_t)(op_end - op)) {
+            return false;
+        }
+
+        memcpy(op, ip, length);
+        op += length;
+        ip += length;
+
+        // the last sequence of a block only has literals
+        if (ip == ip_end) {
+            break;
+        }
+
+        if (ip_end - ip < 2) {
+            return false;
+        }
+
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > (uint32_t)(op - window)) {
+            return false;
+        }
+
+        length = (token & 15) + QOI_LZ_MIN_MATCH;
+
+        if ((token & 15) == 15 && !read_length(&ip, ip_end, &length)) {
+            return false;
+        }
+
+        if (length > (uint32_t)(op_end - op)) {
+            return false;
+        }
+
+        match = op - offset;
+
+        if (offset >= length) {
+            memcpy(op, match, length);
+            op += length;
+        }
+        else {
+            // overlapping matches repeat the last offset bytes so they are copied in order
+            while (length--) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return op == op_end;
+}
@@ -0,0 +1,100 @@
+/*
+
+    qoi_lz.h
+
+    This header contains declaration of the LZ decompressor for QOI files wrapped in a QOI-LZ container
+
+    Code licensed under MIT License
+
+    Copyright (c) 2025-2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_lz.h
+/// @brief This header contains declaration of the LZ decompressor for QOI files wrapped in a QOI-LZ container
+
+#ifndef QOI_LZ_H
+#define QOI_LZ_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    A QOI-LZ file wraps a QOI or QOI-plus file compressed at build time
+
+    qoi_lz_header {
+        char magic[4]; // magic bytes "qoiz"
+        uint32_t size; // size of the wrapped file (BE)
+        uint8_t header[14]; // copy of the wrapped file header so it can be probed
+    };
+
+    The wrapped file follows as blocks of QOI_LZ_BLOCK_SIZE bytes or less
+
+    qoi_lz_block {
+        uint32_t packed_size; // bytes stored for the block (BE)
+        uint32_t size; // bytes the block decompresses to (BE)
+        uint8_t data[packed_size]; // stored as is if packed_size is size
+    };
+
+    Compressed blocks use the LZ4 block format. Matches may reach back up to
+    64 KiB into earlier blocks since the wrapped file is decompressed into one buffer
+*/
+
+/// @brief Size of the QOI-LZ header in bytes
+#define QOI_LZ_HEADER_SIZE 22
+
+/// @brief Size of the header in front of every block in bytes
+#define QOI_LZ_BLOCK_HEADER_SIZE 8
+
+/// @brief Most bytes a block decompresses to. A block is never stored bigger than this
+#define QOI_LZ_BLOCK_SIZE 16384
+
+/// @brief Checks for a QOI-LZ file and reads its header
+/// @param data First QOI_LZ_HEADER_SIZE bytes of the file
+/// @param size Size of the wrapped file in bytes
+/// @return true if the file is a QOI-LZ file
+bool qoi_lz_read_header(const uint8_t* data, uint32_t* size);
+
+/// @brief Reads the header in front of a block
+/// @param data QOI_LZ_BLOCK_HEADER_SIZE bytes of the block header
+/// @param packed_size Bytes stored for the block
+/// @param size Bytes the block decompresses to
+/// @return true if the block fits the limits of the format
+bool qoi_lz_read_block_header(const uint8_t* data, uint32_t* packed_size, uint32_t* size);
+
+/// @brief Decompresses a block right after the blocks before it
+/// @param src Bytes stored for the block
+/// @param packed_size Bytes stored for the block
+/// @param dst Where the block decompresses to. Earlier blocks are right in front of it
+/// @param size Bytes the block decompresses to
+/// @param window Start of the wrapped file. Matches cannot reach in front of it
+/// @return true if the block decompressed to exactly size bytes
+bool qoi_lz_decompress_block(const uint8_t* src, uint32_t packed_size, uint8_t* dst, uint32_t size, const uint8_t* window);
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_LZ_H
@@ -0,0 +1,79 @@
+/*
+
+    qoi_memory.c
+
+    This source code implements the memory plan the QOI viewer picks for the RDRAM installed
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_memory.c
+/// @brief This source code implements the memory plan the QOI viewer picks for the RDRAM installed
+
+#include <stdint.h>
+
+#include <libdragon.h>
+
+#include "qoi_memory.h"
+
+/// @brief Memory plan the viewer runs with
+qoi_memory_plan_t memory_plan = {
+    .rdramSize = 0,
+    .arenaSize = QOI_DEC_ARENA_SIZE,
+    .poolSize = QOI_DEC_POOL_SIZE,
+    .cachedImages = QOI_DEC_CACHED_IMAGES,
+    .prefetchDepth = QOI_DEC_PREFETCH_DEPTH
+};
+
+/// @brief Picks the memory plan for an amount of RDRAM
+/// @param plan Memory plan to fill in
+/// @param rdram_size RDRAM installed in bytes as reported by get_memory_size()
+void qoi_memory_plan_init(qoi_memory_plan_t* plan, size_t rdram_size) {
+    bool expanded = rdram_size >= EXPANDED_MEMORY_SIZE;
+
+    plan->rdramSize = rdram_size;
+    plan->arenaSize = expanded ? QOI_DEC_ARENA_SIZE_EXPANDED : QOI_DEC_ARENA_SIZE;
+    plan->poolSize = expanded ? QOI_DEC_POOL_SIZE_EXPANDED : QOI_DEC_POOL_SIZE;
+    plan->cachedImages = expanded ? QOI_DEC_CACHED_IMAGES_EXPANDED : QOI_DEC_CACHED_IMAGES;
+    plan->prefetchDepth = expanded ? QOI_DEC_PREFETCH_DEPTH_EXPANDED : QOI_DEC_PREFETCH_DEPTH;
+
+    plan->cachedImages = plan->cachedImages < QOI_DEC_MAX_CACHED_IMAGES ? plan->cachedImages : QOI_DEC_MAX_CACHED_IMAGES;
+
+    // images decoded ahead would push each other out of a cache no bigger than the lookahead
+    if (plan->prefetchDepth >= plan->cachedImages) {
+        plan->prefetchDepth = plan->cachedImages > 0 ? plan->cachedImages - 1 : 0;
+    }
+}
+
+/// @brief Prints a memory plan over the debug log
+/// @param plan Memory plan to report on
+void qoi_memory_plan_report(const qoi_memory_plan_t* plan) {
+    debugf(
+        "Memory plan: %u KiB of RDRAM, %u KiB arena, %u KiB image pool, %d cached images, %d prefetched\n",
+        (unsigned int)(plan->rdramSize / 1024),
+        (unsigned int)(plan->arenaSize / 1024),
+        (unsigned int)(plan->poolSize / 1024),
+        plan->cachedImages,
+        plan->prefetchDepth
+    );
+}
@@ -0,0 +1,83 @@
+/*
+
+    qoi_memory.h
+
+    This header contains declaration of the memory plan the QOI viewer picks for the RDRAM installed
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_memory.h
+/// @brief This header contains declaration of the memory plan the QOI viewer picks for the RDRAM installed
+
+#ifndef QOI_MEMORY_H
+#define QOI_MEMORY_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/// @brief Least RDRAM in bytes reported by an N64 with an Expansion Pak. libdragon keeps a little of the 8 MiB for itself
+#define EXPANDED_MEMORY_SIZE 0x7C0000
+
+/// @brief How much memory each part of the viewer gets
+typedef struct qoi_memory_plan {
+    /// @brief RDRAM installed in bytes
+    size_t rdramSize;
+
+    /// @brief Size in bytes of the arena holding the compressed QOI file being decoded
+    size_t arenaSize;
+
+    /// @brief Most bytes the decoded images on screen, cached and prefetched may take together
+    size_t poolSize;
+
+    /// @brief Number of decoded images kept after they leave the screen
+    int cachedImages;
+
+    /// @brief Number of images after the one on screen decoded ahead into the cache
+    int prefetchDepth;
+} qoi_memory_plan_t;
+
+/// @brief Memory plan the viewer runs with
+extern qoi_memory_plan_t memory_plan;
+
+/// @brief Picks the memory plan for an amount of RDRAM
+/// @param plan Memory plan to fill in
+/// @param rdram_size RDRAM installed in bytes as reported by get_memory_size()
+void qoi_memory_plan_init(qoi_memory_plan_t* plan, size_t rdram_size);
+
+/// @brief Prints a memory plan over the debug log
+/// @param plan Memory plan to report on
+void qoi_memory_plan_report(const qoi_memory_plan_t* plan);
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_MEMORY_H
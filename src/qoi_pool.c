@@ -0,0 +1,283 @@
+/*
+
+    qoi_pool.c
+
+    This source code implements the pool of raw image buffers used by the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_pool.c
+/// @brief This source code implements the pool of raw image buffers used by the QOI viewer
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <malloc.h>
+
+#include <libdragon.h>
+
+#include "qoi_pool.h"
+
+/// @brief Pool of the raw image buffers the viewer decodes images into
+qoi_pool_t image_pool = {
+    .base = NULL,
+    .size = 0,
+    .allocated = 0,
+    .highWater = 0
+};
+
+/// @brief Gets the size of the buffers of a size class
+/// @param size_class Size class
+/// @return Size in bytes
+static size_t get_class_size(int size_class) {
+    // 4/4, 5/4, 6/4 and 7/4 of each power of two
+    return (size_t)(4 + (size_class & 3)) * (QOI_POOL_MIN_CLASS_SIZE / 4) << (size_class >> 2);
+}
+
+/// @brief Gets the smallest size class a number of bytes fits in
+/// @param size Size in bytes
+/// @return Size class or -1 if the size is bigger than every class
+static int get_size_class(size_t size) {
+    for (int size_class = 0; size_class < QOI_POOL_CLASSES; size_class++) {
+        if (get_class_size(size_class) >= size) {
+            return size_class;
+        }
+    }
+
+    return -1;
+}
+
+/// @brief Forgets a buffer that is not handed out so its memory can be carved out again
+/// @param pool Pool the buffer belongs to
+/// @param buffer Buffer to forget
+static void release_buffer(qoi_pool_t* pool, qoi_pool_buffer_t* buffer) {
+    pool->allocated -= get_class_size(buffer->sizeClass);
+    buffer->pixels = NULL;
+    buffer->used = false;
+}
+
+/// @brief Finds where in the memory of a pool a new buffer goes
+/// @details Only buffers handed out are in the way. The buffer goes into the smallest gap between them it fits in,
+/// against the end of the memory if the gap reaches it so the bottom is left whole for the next buffer
+/// @param pool Pool to search
+/// @param size Size of the buffer in bytes
+/// @return Offset of the buffer from the start of the memory or -1 if no gap is big enough
+static ptrdiff_t find_gap(qoi_pool_t* pool, size_t size) {
+    qoi_pool_buffer_t* used[QOI_DEC_POOL_BUFFERS];
+    int used_count = 0;
+    ptrdiff_t best = -1;
+    size_t best_size = 0;
+    size_t start = 0;
+
+    // buffers handed out sorted by address
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS; i++) {
+        qoi_pool_buffer_t* buffer = &pool->buffers[i];
+        int j = used_count++;
+
+        if (!buffer->pixels || !buffer->used) {
+            used_count--;
+            continue;
+        }
+
+        for (; j > 0 && used[j - 1]->pixels > buffer->pixels; j--) {
+            used[j] = used[j - 1];
+        }
+
+        used[j] = buffer;
+    }
+
+    for (int i = 0; i <= used_count; i++) {
+        size_t end = i < used_count ? (size_t)(used[i]->pixels - pool->base) : pool->size;
+        size_t gap = end - start;
+
+        if (gap >= size && (best < 0 || gap < best_size)) {
+            best = (ptrdiff_t)(end == pool->size ? end - size : start);
+            best_size = gap;
+        }
+
+        if (i < used_count) {
+            start = end + get_class_size(used[i]->sizeClass);
+        }
+    }
+
+    return best;
+}
+
+/// @brief Allocates the memory of a pool. Only call this once at boot
+/// @param pool Pool to set up
+/// @param size Size of the memory the buffers are carved out of in bytes
+/// @return true if the memory was allocated
+bool qoi_pool_init(qoi_pool_t* pool, size_t size) {
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS; i++) {
+        pool->buffers[i] = (qoi_pool_buffer_t){.pixels = NULL, .sizeClass = 0, .used = false};
+    }
+
+    pool->size = size & ~(size_t)(QOI_POOL_ALIGNMENT - 1);
+    pool->base = (uint8_t*)memalign(QOI_POOL_ALIGNMENT, pool->size);
+    pool->allocated = 0;
+    pool->highWater = 0;
+
+    return pool->base != NULL;
+}
+
+/// @brief Hands out a buffer, reusing a buffer of the same size class that was given back if there is one
+/// @param pool Pool to allocate from
+/// @param size Size of the buffer in bytes
+/// @return Buffer aligned to QOI_POOL_ALIGNMENT or NULL if the buffers handed out leave no room for it
+uint8_t* qoi_pool_alloc(qoi_pool_t* pool, size_t size) {
+    int size_class = get_size_class(size);
+    qoi_pool_buffer_t* entry = NULL;
+    size_t class_size;
+    ptrdiff_t offset;
+    uint8_t* pixels;
+
+    if (size_class < 0 || !pool->base) {
+        return NULL;
+    }
+
+    class_size = get_class_size(size_class);
+
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS; i++) {
+        qoi_pool_buffer_t* buffer = &pool->buffers[i];
+
+        if (buffer->pixels && !buffer->used && buffer->sizeClass == size_class) {
+            buffer->used = true;
+            return buffer->pixels;
+        }
+    }
+
+    offset = find_gap(pool, class_size);
+
+    if (offset < 0) {
+        return NULL;
+    }
+
+    pixels = pool->base + offset;
+
+    // buffers not handed out that overlap the new one give up their memory
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS; i++) {
+        qoi_pool_buffer_t* buffer = &pool->buffers[i];
+
+        if (buffer->pixels && !buffer->used &&
+            buffer->pixels < pixels + class_size &&
+            buffer->pixels + get_class_size(buffer->sizeClass) > pixels
+        ) {
+            release_buffer(pool, buffer);
+        }
+    }
+
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS && !entry; i++) {
+        if (!pool->buffers[i].pixels) {
+            entry = &pool->buffers[i];
+        }
+    }
+
+    // every entry holds a buffer so one of another size class that is not handed out makes way
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS && !entry; i++) {
+        if (!pool->buffers[i].used) {
+            entry = &pool->buffers[i];
+            release_buffer(pool, entry);
+        }
+    }
+
+    if (!entry) {
+        return NULL;
+    }
+
+    entry->pixels = pixels;
+    entry->sizeClass = size_class;
+    entry->used = true;
+
+    pool->allocated += class_size;
+
+    if (pool->allocated > pool->highWater) {
+        pool->highWater = pool->allocated;
+    }
+
+    return entry->pixels;
+}
+
+/// @brief Gives a buffer back to be reused. It keeps its place until a new buffer needs the room
+/// @param pool Pool the buffer came from
+/// @param pixels Buffer to give back or NULL
+void qoi_pool_free(qoi_pool_t* pool, uint8_t* pixels) {
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS && pixels; i++) {
+        if (pool->buffers[i].pixels == pixels) {
+            pool->buffers[i].used = false;
+        }
+    }
+}
+
+/// @brief Gets a buffer of another size, keeping the buffer given if it is of the same size class
+/// @details Unlike realloc() the contents are only kept when the same buffer is returned
+/// @param pool Pool the buffer came from
+/// @param pixels Buffer to resize or NULL
+/// @param size Size of the buffer in bytes
+/// @return Buffer aligned to QOI_POOL_ALIGNMENT or NULL if the buffers handed out leave no room for it
+uint8_t* qoi_pool_realloc(qoi_pool_t* pool, uint8_t* pixels, size_t size) {
+    int size_class = get_size_class(size);
+
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS && pixels; i++) {
+        if (pool->buffers[i].pixels == pixels && pool->buffers[i].sizeClass == size_class) {
+            return pixels;
+        }
+    }
+
+    qoi_pool_free(pool, pixels);
+
+    return qoi_pool_alloc(pool, size);
+}
+
+/// @brief Forgets every buffer that is not handed out
+/// @param pool Pool to trim
+void qoi_pool_trim(qoi_pool_t* pool) {
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS; i++) {
+        if (pool->buffers[i].pixels && !pool->buffers[i].used) {
+            release_buffer(pool, &pool->buffers[i]);
+        }
+    }
+}
+
+/// @brief Prints how much memory a pool takes over the debug log
+/// @param pool Pool to report on
+/// @param name Name of the pool in the report
+void qoi_pool_report(qoi_pool_t* pool, const char* name) {
+    int used = 0, spare = 0;
+
+    for (int i = 0; i < QOI_DEC_POOL_BUFFERS; i++) {
+        if (pool->buffers[i].pixels) {
+            used += pool->buffers[i].used;
+            spare += !pool->buffers[i].used;
+        }
+    }
+
+    debugf(
+        "%s pool: %d buffers in use, %d spare, %u bytes allocated, %u bytes high water, %u bytes reserved\n",
+        name,
+        used,
+        spare,
+        (unsigned int)pool->allocated,
+        (unsigned int)pool->highWater,
+        (unsigned int)pool->size
+    );
+}
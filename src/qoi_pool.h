@@ -0,0 +1,129 @@
+/*
+
+    qoi_pool.h
+
+    This header contains declaration of the pool of raw image buffers used by the QOI viewer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_pool.h
+/// @brief This header contains declaration of the pool of raw image buffers used by the QOI viewer
+
+#ifndef QOI_POOL_H
+#define QOI_POOL_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/// @brief Alignment of every buffer in bytes, matching a data cache line
+#define QOI_POOL_ALIGNMENT 16
+
+/// @brief Size of the smallest size class in bytes
+#define QOI_POOL_MIN_CLASS_SIZE 1024
+
+/// @brief Number of size classes. Each power of two is split into four classes so a buffer is at most a quarter bigger than asked for
+#define QOI_POOL_CLASSES 48
+
+/// @brief A buffer carved out of the memory of the pool
+typedef struct qoi_pool_buffer {
+    /// @brief Memory of the buffer or NULL if the entry is free
+    uint8_t* pixels;
+
+    /// @brief Size class of the buffer
+    int sizeClass;
+
+    /// @brief Whether the buffer is handed out. Buffers not handed out are kept for the next image of their size class
+    bool used;
+} qoi_pool_buffer_t;
+
+/// @brief Raw image buffers sized to the images decoded into them
+/// @details Buffers are rounded up to a size class and carved out of one block of memory allocated at boot,
+/// so images never allocate from the heap. Buffers given back keep their place until a new buffer needs it,
+/// so images of about the same size reuse the same memory
+typedef struct qoi_pool {
+    /// @brief Start of the memory owned by the pool
+    uint8_t* base;
+
+    /// @brief Size of the memory owned by the pool in bytes
+    size_t size;
+
+    /// @brief Buffers carved out so far
+    qoi_pool_buffer_t buffers[QOI_DEC_POOL_BUFFERS];
+
+    /// @brief Bytes the buffers take together, handed out or not
+    size_t allocated;
+
+    /// @brief Most bytes the buffers ever took together
+    size_t highWater;
+} qoi_pool_t;
+
+/// @brief Pool of the raw image buffers the viewer decodes images into
+extern qoi_pool_t image_pool;
+
+/// @brief Allocates the memory of a pool. Only call this once at boot
+/// @param pool Pool to set up
+/// @param size Size of the memory the buffers are carved out of in bytes
+/// @return true if the memory was allocated
+bool qoi_pool_init(qoi_pool_t* pool, size_t size);
+
+/// @brief Hands out a buffer, reusing a buffer of the same size class that was given back if there is one
+/// @param pool Pool to allocate from
+/// @param size Size of the buffer in bytes
+/// @return Buffer aligned to QOI_POOL_ALIGNMENT or NULL if the buffers handed out leave no room for it
+uint8_t* qoi_pool_alloc(qoi_pool_t* pool, size_t size);
+
+/// @brief Gives a buffer back to be reused. It keeps its place until a new buffer needs the room
+/// @param pool Pool the buffer came from
+/// @param pixels Buffer to give back or NULL
+void qoi_pool_free(qoi_pool_t* pool, uint8_t* pixels);
+
+/// @brief Gets a buffer of another size, keeping the buffer given if it is of the same size class
+/// @details Unlike realloc() the contents are only kept when the same buffer is returned
+/// @param pool Pool the buffer came from
+/// @param pixels Buffer to resize or NULL
+/// @param size Size of the buffer in bytes
+/// @return Buffer aligned to QOI_POOL_ALIGNMENT or NULL if the buffers handed out leave no room for it
+uint8_t* qoi_pool_realloc(qoi_pool_t* pool, uint8_t* pixels, size_t size);
+
+/// @brief Forgets every buffer that is not handed out
+/// @param pool Pool to trim
+void qoi_pool_trim(qoi_pool_t* pool);
+
+/// @brief Prints how much memory a pool takes over the debug log
+/// @param pool Pool to report on
+/// @param name Name of the pool in the report
+void qoi_pool_report(qoi_pool_t* pool, const char* name);
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_POOL_H
@@ -0,0 +1,144 @@
+/*
+
+    qoi_thumbnail.c
+
+    This source code implements the store of thumbnails shown by the browser
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_thumbnail.c
+/// @brief This source code implements the store of thumbnails shown by the browser
+
+#include <stddef.h>
+
+#include <libdragon.h>
+
+#include "qoi_thumbnail.h"
+
+/// @brief RGBA16 pixels of every slot of a thumbnail store
+static uint8_t thumbnail_pixels[QOI_DEC_THUMBNAIL_SLOTS][QOI_THUMBNAIL_SIZE] __attribute__((aligned(16)));
+
+/// @brief Finds a slot to make a thumbnail in, dropping the least recently asked for thumbnail if none is free
+/// @param store Store to find the slot in
+/// @return Slot or NULL if every thumbnail was asked for by this call of qoi_thumbnail_make()
+static qoi_thumbnail_t* get_free_slot(qoi_thumbnail_store_t* store) {
+    qoi_thumbnail_t* oldest = NULL;
+
+    for (int i = 0; i < QOI_DEC_THUMBNAIL_SLOTS; i++) {
+        qoi_thumbnail_t* slot = &store->slots[i];
+
+        if (!slot->name) {
+            return slot;
+        }
+
+        if (slot->lastUsed != store->clock && (!oldest || slot->lastUsed < oldest->lastUsed)) {
+            oldest = slot;
+        }
+    }
+
+    return oldest;
+}
+
+void qoi_thumbnail_init(qoi_thumbnail_store_t* store) {
+    for (int i = 0; i < QOI_DEC_THUMBNAIL_SLOTS; i++) {
+        store->slots[i].name = NULL;
+        store->slots[i].pixels = thumbnail_pixels[i];
+        store->slots[i].lastUsed = 0;
+    }
+
+    store->making = NULL;
+    store->clock = 0;
+}
+
+qoi_thumbnail_t* qoi_thumbnail_find(qoi_thumbnail_store_t* store, const char* name) {
+    for (int i = 0; i < QOI_DEC_THUMBNAIL_SLOTS; i++) {
+        if (store->slots[i].name == name) {
+            return &store->slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+void qoi_thumbnail_make(qoi_thumbnail_store_t* store, const char* const* names, int count, long long budget) {
+    long long start = timer_ticks();
+    int next = 0;
+
+    store->clock++;
+
+    // thumbnails in the list are kept over the ones that are not
+    for (int i = 0; i < count; i++) {
+        qoi_thumbnail_t* thumbnail = qoi_thumbnail_find(store, names[i]);
+
+        if (thumbnail) {
+            thumbnail->lastUsed = store->clock;
+        }
+    }
+
+    for (;;) {
+        long long remaining = budget - (timer_ticks() - start);
+
+        // stepQOIDecode() takes a budget of 0 or less as decoding the whole image
+        if (remaining <= 0) {
+            return;
+        }
+
+        if (!store->making) {
+            qoi_thumbnail_t* slot;
+
+            while (next < count && qoi_thumbnail_find(store, names[next])) {
+                next++;
+            }
+
+            if (next >= count || !(slot = get_free_slot(store))) {
+                return;
+            }
+
+            slot->name = names[next];
+            slot->lastUsed = store->clock;
+            slot->info.error = QOI_NOT_INITIALIZED;
+
+            // a thumbnail that cannot be made keeps its slot with the error so it is not tried again
+            if (!beginQOIThumbnail(slot->name, slot->pixels, &slot->info)) {
+                continue;
+            }
+
+            store->making = slot;
+        }
+
+        if (stepQOIDecode(remaining)) {
+            store->making = NULL;
+        }
+    }
+}
+
+void qoi_thumbnail_cancel(qoi_thumbnail_store_t* store) {
+    if (store->making) {
+        cancelQOIDecode();
+
+        // the slot is freed so the thumbnail is made from the start next time
+        store->making->name = NULL;
+        store->making = NULL;
+    }
+}
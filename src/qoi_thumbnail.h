@@ -0,0 +1,100 @@
+/*
+
+    qoi_thumbnail.h
+
+    This header contains declaration of the store of thumbnails shown by the browser
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file qoi_thumbnail.h
+/// @brief This header contains declaration of the store of thumbnails shown by the browser
+
+#ifndef QOI_THUMBNAIL_H
+#define QOI_THUMBNAIL_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "qoi_viewer.h"
+
+/// @brief A thumbnail of a QOI file kept in the store
+typedef struct qoi_thumbnail {
+    /// @brief Name of the QOI file the thumbnail is of or NULL if the slot is free
+    const char* name;
+
+    /// @brief Thumbnail as decoded. The error is QOI_NOT_INITIALIZED while it is being made
+    qoi_img_info_t info;
+
+    /// @brief Memory of QOI_THUMBNAIL_SIZE bytes the thumbnail is decoded into
+    uint8_t* pixels;
+
+    /// @brief Value of the store clock when the thumbnail was last asked for
+    uint32_t lastUsed;
+} qoi_thumbnail_t;
+
+/// @brief Thumbnails made so far, the least recently asked for making room for new ones
+typedef struct qoi_thumbnail_store {
+    /// @brief Slots of the store
+    qoi_thumbnail_t slots[QOI_DEC_THUMBNAIL_SLOTS];
+
+    /// @brief Thumbnail being decoded or NULL
+    qoi_thumbnail_t* making;
+
+    /// @brief Counts the calls to qoi_thumbnail_make()
+    uint32_t clock;
+} qoi_thumbnail_store_t;
+
+/// @brief Empties a thumbnail store and hands its slots their memory
+/// @param store Store to set up
+void qoi_thumbnail_init(qoi_thumbnail_store_t* store);
+
+/// @brief Finds the thumbnail of a QOI file
+/// @param store Store to look in
+/// @param name Name of the QOI file. Compared by address so it must stay in memory
+/// @return Thumbnail, which may still be being made, or NULL if the store has none
+qoi_thumbnail_t* qoi_thumbnail_find(qoi_thumbnail_store_t* store, const char* name);
+
+/// @brief Makes the thumbnails missing from a list of QOI files one after another until the time runs out
+/// @details Thumbnails not in the list are dropped to make room when the store is full. The decoder is used
+/// by the store until the list is done or qoi_thumbnail_cancel() is called
+/// @param store Store to put the thumbnails in
+/// @param names Names of the QOI files in the order their thumbnails are needed. Compared by address
+/// @param count Number of names. At most QOI_DEC_THUMBNAIL_SLOTS are kept
+/// @param budget Ticks to spend before returning
+void qoi_thumbnail_make(qoi_thumbnail_store_t* store, const char* const* names, int count, long long budget);
+
+/// @brief Stops making the thumbnail being made, freeing the decoder
+/// @param store Store making the thumbnail
+void qoi_thumbnail_cancel(qoi_thumbnail_store_t* store);
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_THUMBNAIL_H
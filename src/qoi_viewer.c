@@ -40,179 +40,1999 @@
 #include <string.h>
 
 #include "config.h"
+
+#if QOI_DEC_PROFILE_DECODER
+#include <libdragon.h>
+
+// COP0 Count goes up once every two CPU cycles
+#define QOI_PROFILE_CLOCK() C0_COUNT()
+#endif
+
 #include "sQOI.h"
 #include "qoi_viewer.h"
+#include "qoi_arena.h"
+#include "qoi_pool.h"
+#include "qoi_memory.h"
+#include "qoi_lz.h"
+#include "qoi_load.h"
+
+#include <assert.h>
+
+/// @brief Display list holding the recorded debug overlay text
+static rspq_block_t* overlay_block = NULL;
+
+/// @brief Image metadata the cached debug overlay was recorded with
+static qoi_img_info_t overlay_info;
+
+/// @brief Ticks spent on the debug overlay since the statistics were last printed
+static long long overlay_ticks = 0;
+
+/// @brief Ticks spent the last time the debug overlay was recorded
+static long long overlay_record_ticks = 0;
+
+/// @brief Frames drawn since the debug overlay statistics were last printed
+static int overlay_frames = 0;
+
+/// @brief Checks if the cached debug overlay no longer matches the image metadata
+/// @param info QOI info of the image being drawn
+/// @return true if the debug overlay has to be recorded again
+static bool overlay_is_stale(const qoi_img_info_t* info) {
+    return overlay_block == NULL ||
+        overlay_info.width != info->width ||
+        overlay_info.height != info->height ||
+        overlay_info.channels != info->channels ||
+        overlay_info.colorspace != info->colorspace ||
+        overlay_info.srcWidth != info->srcWidth ||
+        overlay_info.srcHeight != info->srcHeight ||
+        overlay_info.zoomMode != info->zoomMode ||
+        overlay_info.decodeTime != info->decodeTime ||
+        strncmp(overlay_info.name, info->name, 256) != 0;
+}
+
+/// @brief Lays out and draws the debug overlay text
+/// @param info QOI info of the image being drawn
+static void print_overlay(const qoi_img_info_t* info) {
+    const char rgbStr[] = "RGB";
+    const char rgbaStr[] = "RGBA";
+    const char unknownStr[] = "???";
+    const char* zoomStr[QOI_ZOOM_MODES] = {"1:1", "Fit", "Fill", "Integer"};
+    const char* channelStr;
+
+    if (info->channels == 3) {
+        channelStr = rgbStr;
+    } else if (info->channels == 4) {
+        channelStr = rgbaStr;
+    }
+    else {
+        channelStr = unknownStr;
+    }
+
+    rdpq_text_printf(
+        &(rdpq_textparms_t) {
+            .width = 320-32,
+            .align = ALIGN_LEFT,
+            .wrap = WRAP_WORD,
+        }, 
+        1, 
+        32, 
+        32, 
+        "N64 QOI Viewer (Revised: %s)\n"
+        "Current Image: %s\n"
+        "Size: %i x %i (1/%i)\n"
+        "Channels: %i (%s)\n"
+        "Colorspace: %s\n"
+        "Zoom: %s\n"
+        "Decode Time: %f ms\n"
+        "RDRAM: %i MB\n"
+        "Files: %i KiB, Images: %i KiB\n"
+        "Cached: %i, Ahead: %i",
+        QOI_DEC_REVISION_DATE,
+        info->name,
+        info->srcWidth,
+        info->srcHeight,
+        1 << info->downscaleShift,
+        info->channels,
+        channelStr,
+        info->colorspace == QOI_LINEAR ? "Linear" : "sRGB",
+        zoomStr[info->zoomMode],
+        info->decodeTime * 1000.0f,
+        (int)(memory_plan.rdramSize >> 20),
+        (int)(memory_plan.arenaSize >> 10),
+        (int)(memory_plan.poolSize >> 10),
+        memory_plan.cachedImages,
+        memory_plan.prefetchDepth
+        );
+}
+
+/// @brief Records the debug overlay text into a display list
+/// @param info QOI info of the image being drawn
+static void record_overlay(const qoi_img_info_t* info) {
+    if (overlay_block) {
+        rspq_block_free(overlay_block);
+    }
+
+    // text layout and float formatting only happen here
+    // so every other frame replays the recorded commands
+    rspq_block_begin();
+    print_overlay(info);
+
+    overlay_block = rspq_block_end();
+    overlay_info = *info;
+}
+
+/// @brief Gets the scale factor for drawing an image with a zoom mode
+/// @param info QOI info of the image being drawn
+/// @return Scale factor applied by the RDP
+static float get_zoom_scale(const qoi_img_info_t* info) {
+    float scale_x = (float)SCREEN_WIDTH / (float)info->width;
+    float scale_y = (float)SCREEN_HEIGHT / (float)info->height;
+    float fit = scale_x < scale_y ? scale_x : scale_y;
+
+    switch (info->zoomMode) {
+        case QOI_ZOOM_FIT:
+            return fit;
+        case QOI_ZOOM_FILL:
+            return scale_x > scale_y ? scale_x : scale_y;
+        case QOI_ZOOM_INTEGER:
+            return fit < 1.0f ? 1.0f : (float)(int)fit;
+        default:
+            return 1.0f;
+    }
+}
+
+/// @brief Starts drawing a frame with a black background
+/// @param disp Surface image
+static void begin_frame(surface_t* disp) {
+    rdpq_attach(disp, NULL);
+
+    rdpq_set_mode_fill(RGBA32(0, 0, 0, 255));
+    rdpq_fill_rectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+/// @brief Squares of the background behind RGBA images as a 2x2 texture repeated over the image
+static uint16_t background_texels[4] __attribute__((aligned(8)));
+
+/// @brief Whether the background texture has been filled in
+static bool background_ready = false;
+
+/// @brief Draws the background behind the transparent parts of an RGBA image
+/// @param x0 Left edge of the image on screen
+/// @param y0 Top edge of the image on screen
+/// @param x1 Right edge of the image on screen
+/// @param y1 Bottom edge of the image on screen
+/// @param alpha Opacity of the image where 255 is fully opaque
+static void draw_background(float x0, float y0, float x1, float y1, uint8_t alpha) {
+    if (!background_ready) {
+        uint16_t light = color_to_packed16(QOI_DEC_BACKGROUND_COLOR);
+        uint16_t dark = QOI_DEC_BACKGROUND == QOI_BACKGROUND_CHECKERBOARD ?
+            color_to_packed16(QOI_DEC_CHECKERBOARD_COLOR) :
+            light;
+
+        background_texels[0] = light;
+        background_texels[1] = dark;
+        background_texels[2] = dark;
+        background_texels[3] = light;
+
+        // the RDP reads the texture from memory
+        data_cache_hit_writeback(background_texels, sizeof(background_texels));
+        background_ready = true;
+    }
+
+    surface_t squares = surface_make_linear(background_texels, FMT_RGBA16, 2, 2);
+
+    rdpq_set_mode_standard();
+    rdpq_mode_filter(FILTER_POINT);
+
+    if (alpha < 255) {
+        rdpq_mode_combiner(RDPQ_COMBINER1((0,0,0,TEX0), (0,0,0,PRIM)));
+        rdpq_mode_blender(RDPQ_BLENDER_MULTIPLY);
+        rdpq_set_prim_color(RGBA32(255, 255, 255, alpha));
+    }
+
+    rdpq_tex_upload(TILE0, &squares, &(rdpq_texparms_t) {
+        .s.repeats = REPEAT_INFINITE,
+        .t.repeats = REPEAT_INFINITE
+    });
+
+    // each texel is stretched over one square
+    rdpq_texture_rectangle_scaled(
+        TILE0,
+        x0, y0, x1, y1,
+        0.0f, 0.0f, (x1 - x0) / QOI_DEC_CHECKERBOARD_SIZE, (y1 - y0) / QOI_DEC_CHECKERBOARD_SIZE
+    );
+}
+
+/// @brief Draws the decoded image into the center of the screen
+/// @param info QOI info for drawing image properly
+/// @param alpha Opacity of the image where 255 is fully opaque
+static void blit_image(const qoi_img_info_t* info, uint8_t alpha) {
+    surface_t image = surface_make_linear(
+        info->pixels,
+        info->format,
+        info->width,
+        info->height
+    );
+
+    float scale = get_zoom_scale(info);
+    bool filtering = scale != 1.0f;
+    float x = ((float)SCREEN_WIDTH - info->width * scale) * 0.5f;
+    float y = ((float)SCREEN_HEIGHT - info->height * scale) * 0.5f;
+
+    // I8 textures have the intensity where the alpha would be
+    bool transparent = info->channels == 4 && info->format != FMT_I8;
+    bool premultiplied = transparent && QOI_OUTPUT_PREMULTIPLIED[QOI_DEC_OUTPUT_FORMAT];
+
+    rdpq_blitparms_t parms = {
+        .scale_x = scale,
+        .scale_y = scale,
+        .filtering = filtering
+    };
+
+    if (transparent && QOI_DEC_BACKGROUND != QOI_BACKGROUND_NONE) {
+        draw_background(x, y, x + info->width * scale, y + info->height * scale, alpha);
+    }
+
+    rdpq_set_mode_standard();
+
+    if (info->palette) {
+        // the RDP looks up the colors of CI4 and CI8 images in the palette loaded into TMEM
+        rdpq_mode_tlut(TLUT_RGBA16);
+        rdpq_tex_upload_tlut(info->palette, 0, info->paletteSize);
+    }
+
+    // let the RDP do the resampling so the CPU never touches the pixels
+    rdpq_mode_filter(filtering ? FILTER_BILINEAR : FILTER_POINT);
+
+    if (premultiplied) {
+        // the blender cannot add the texture to what is behind it scaled by 1 - alpha in one pass
+        // so the first pass darkens what is behind and the second adds the premultiplied colors on top
+        rdpq_mode_combiner(RDPQ_COMBINER1((0,0,0,0), (TEX0,0,PRIM,0)));
+        rdpq_mode_blender(RDPQ_BLENDER_MULTIPLY);
+        rdpq_set_prim_color(RGBA32(alpha, alpha, alpha, alpha));
+
+        rdpq_tex_blit(&image, x, y, &parms);
+
+        rdpq_mode_combiner(RDPQ_COMBINER1((TEX0,0,PRIM,0), (0,0,0,1)));
+        rdpq_mode_blender(RDPQ_BLENDER_ADDITIVE);
+    }
+    else if (transparent) {
+        // blend the image over what has been drawn using its own alpha times the primitive alpha
+        rdpq_mode_combiner(RDPQ_COMBINER1((0,0,0,TEX0), (TEX0,0,PRIM,0)));
+        rdpq_mode_blender(RDPQ_BLENDER_MULTIPLY);
+        rdpq_set_prim_color(RGBA32(255, 255, 255, alpha));
+    }
+    else if (alpha < 255) {
+        // fade the image over what has been drawn using the primitive alpha
+        rdpq_mode_combiner(RDPQ_COMBINER1((0,0,0,TEX0), (0,0,0,PRIM)));
+        rdpq_mode_blender(RDPQ_BLENDER_MULTIPLY);
+        rdpq_set_prim_color(RGBA32(255, 255, 255, alpha));
+    }
+
+    rdpq_tex_blit(&image, x, y, &parms);
+}
+
+/// @brief Draws the debug overlay text if it is enabled
+/// @param info QOI info for drawing image properly
+static void draw_overlay(const qoi_img_info_t* info) {
+    if (info->renderDebugFont == true) {
+        long long start = timer_ticks();
+
+#if QOI_DEC_OVERLAY_CACHE
+        if (overlay_is_stale(info)) {
+            record_overlay(info);
+            overlay_record_ticks = timer_ticks() - start;
+        }
+
+        rspq_block_run(overlay_block);
+#else
+        print_overlay(info);
+#endif
+
+        overlay_ticks += timer_ticks() - start;
+        overlay_frames++;
+
+#if QOI_DEC_OVERLAY_STATS_FRAMES > 0
+        if (overlay_frames >= QOI_DEC_OVERLAY_STATS_FRAMES) {
+#if QOI_DEC_OVERLAY_CACHE
+            // recording costs the same CPU time as formatting the text every frame
+            debugf(
+                "Debug overlay: %lld us per frame cached, %lld us to record\n",
+                TICKS_TO_US(overlay_ticks / overlay_frames),
+                TICKS_TO_US(overlay_record_ticks)
+            );
+#else
+            debugf("Debug overlay: %lld us per frame uncached\n", TICKS_TO_US(overlay_ticks / overlay_frames));
+#endif
+
+            overlay_ticks = 0;
+            overlay_frames = 0;
+        }
+#endif
+    }
+}
+
+/// @brief This function draws image decoded from QOI
+/// @param disp Surface image
+/// @param info QOI info for drawing image properly
+void draw_image(surface_t* disp, qoi_img_info_t info) {
+    begin_frame(disp);
+
+    blit_image(&info, 255);
+
+    draw_overlay(&info);
+
+    rdpq_detach_show();
+}
+
+/// @brief This function draws a transition between two decoded images
+/// @param disp Surface image
+/// @param from QOI info of the image being transitioned from
+/// @param to QOI info of the image being transitioned to
+/// @param transition How to transition between the two images
+/// @param progress How far along the transition is from 0.0 to 1.0
+void draw_transition(surface_t* disp, qoi_img_info_t* from, qoi_img_info_t* to, qoi_transition_t transition, float progress) {
+    begin_frame(disp);
+
+    blit_image(from, 255);
+
+    if (transition == QOI_TRANSITION_WIPE) {
+        // reveal the next image from left to right
+        rdpq_set_scissor(0, 0, (int)(SCREEN_WIDTH * progress), SCREEN_HEIGHT);
+        blit_image(to, 255);
+        rdpq_set_scissor(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+    else {
+        blit_image(to, (uint8_t)(progress * 255.0f));
+    }
+
+    draw_overlay(from);
+
+    rdpq_detach_show();
+}
+
+/// @brief Width of a cell of the browser in pixels
+#define BROWSER_CELL_WIDTH (SCREEN_WIDTH / BROWSER_COLUMNS)
+
+/// @brief Height of a cell of the browser in pixels. The last 24 rows of the screen hold the name of the selected image
+#define BROWSER_CELL_HEIGHT ((SCREEN_HEIGHT - 24) / BROWSER_ROWS)
+
+/// @brief Color of the frame around the selected thumbnail
+#define BROWSER_SELECTION_COLOR RGBA32(255, 255, 255, 255)
+
+/// @brief Color of the cells whose thumbnail is not made yet
+#define BROWSER_PLACEHOLDER_COLOR RGBA32(48, 48, 48, 255)
+
+/// @brief Draws a page of thumbnails in a grid with the name of the selected image under it
+/// @param disp Surface image
+/// @param thumbnails Thumbnail of each cell from left to right and top to bottom or NULL if it is not made yet
+/// @param count Number of cells on the page, at most BROWSER_COLUMNS * BROWSER_ROWS
+/// @param selected Cell of the selected image
+/// @param name Name of the selected image
+void draw_browser(surface_t* disp, const qoi_img_info_t* const* thumbnails, int count, int selected, const char* name) {
+    begin_frame(disp);
+
+    for (int i = 0; i < count; i++) {
+        const qoi_img_info_t* thumbnail = thumbnails[i];
+        bool ready = thumbnail && thumbnail->error == QOI_OK;
+        int width = ready ? thumbnail->width : QOI_THUMBNAIL_WIDTH;
+        int height = ready ? thumbnail->height : QOI_THUMBNAIL_HEIGHT;
+
+        // thumbnails smaller than the biggest one are centered in their cell
+        float x = (i % BROWSER_COLUMNS) * BROWSER_CELL_WIDTH + (BROWSER_CELL_WIDTH - width) / 2;
+        float y = (i / BROWSER_COLUMNS) * BROWSER_CELL_HEIGHT + (BROWSER_CELL_HEIGHT - height) / 2;
+
+        if (i == selected) {
+            rdpq_set_mode_fill(BROWSER_SELECTION_COLOR);
+            rdpq_fill_rectangle(x - 2, y - 2, x + width + 2, y + height + 2);
+        }
+
+        if (ready) {
+            surface_t image = surface_make_linear(thumbnail->pixels, thumbnail->format, width, height);
+
+            // thumbnails are opaque since their transparent parts are put over the background while decoding
+            rdpq_set_mode_standard();
+            rdpq_tex_blit(&image, x, y, NULL);
+        }
+        else {
+            rdpq_set_mode_fill(BROWSER_PLACEHOLDER_COLOR);
+            rdpq_fill_rectangle(x, y, x + width, y + height);
+        }
+    }
+
+    rdpq_text_printf(
+        &(rdpq_textparms_t) {
+            .width = SCREEN_WIDTH - 32,
+            .align = ALIGN_LEFT,
+            .wrap = WRAP_ELLIPSES,
+        },
+        1,
+        16,
+        SCREEN_HEIGHT - 8,
+        "%s",
+        name
+    );
+
+    rdpq_detach_show();
+}
+
+
+/// @brief Bytes read from the cartridge at a time when loading a QOI file
+#define READ_CHUNK_SIZE 16384
+
+/// @brief Most bytes a QOI chunk takes for one pixel. Rows are decoded once this many bytes per pixel are ready
+#define MAX_BYTES_PER_PIXEL 5
+
+/// @brief QOI animation magic number
+static const uint8_t QOI_ANIM_MAGIC[4] = {'q', 'o', 'i', 'a'};
+
+/// @brief State of a QOI image being decoded over multiple slices
+typedef struct qoi_decode_job {
+    /// @brief QOI file being read. NULL once the whole file is read or when it is read with PI DMA
+    FILE* fp;
+
+    /// @brief Transfer of the QOI file from the cartridge with PI DMA. Inactive when it is read with fp
+    qoi_load_t load;
+
+    /// @brief Whether the job closes the file once it is read. Frames of a QOI animation share its file
+    bool ownsFile;
+
+    /// @brief QOI animation the image is a frame of or NULL for a still image
+    qoi_anim_t* anim;
+
+    /// @brief QOI descriptor read from the header
+    qoi_desc_t desc;
+
+    /// @brief QOI decoder state carried between slices
+    qoi_dec_t dec;
+
+    /// @brief Encoded QOI file
+    uint8_t* qoi_bytes;
+
+    /// @brief Block of a QOI-LZ file as read from the cartridge or NULL for other files
+    uint8_t* packed;
+
+    /// @brief Sums of the color channels of the output row being box filtered
+    uint16_t* sums;
+
+    /// @brief Averaged pixels of the output row being box filtered
+    qoi_pixel_t* averages;
+
+    /// @brief Sums of each column of the thumbnail row being made as red, green and blue weighted by alpha, then alpha
+    uint32_t* thumbnailSums;
+
+    /// @brief Whether the image is shrunk into a thumbnail instead of being decoded to show
+    bool thumbnail;
+
+    /// @brief Rectangle of the QOI image decoded when it is cropped
+    qoi_region_t region;
+
+    /// @brief Whether only the region of the QOI image is decoded, at full resolution
+    bool cropped;
+
+    /// @brief Table the color channels are looked up in to match the colorspace of the framebuffer or NULL
+    const uint8_t* transfer;
+
+    /// @brief Span decoder picked for the image and output format
+    qoi_span_decoder_t decodeSpan;
+
+    /// @brief Span decoder for full resolution rows as RGBA32
+    qoi_span_decoder_t sourceSpan;
+
+    /// @brief Full resolution rows as RGBA32 used to box filter and to undo row filters
+    uint32_t* sourceRows[2];
+
+    /// @brief Row filters of a QOI-plus file or NULL for a QOI file
+    const uint8_t* filters;
+
+    /// @brief Next full resolution row to decode
+    int sourceRow;
+
+    /// @brief Colors of the palette of an image decoded as palette indices as RGBA32
+    uint32_t* paletteColors;
+
+    /// @brief Open addressed table from colors to their palette index plus one where 0 is a free slot
+    uint16_t* paletteSlots;
+
+    /// @brief Number of colors in the palette so far
+    int paletteSize;
+
+    /// @brief Whether rows are decoded as palette indices
+    bool indexed;
+
+    /// @brief Arena mark to release the memory of this job with
+    size_t arenaMark;
+
+    /// @brief Size of the QOI file in bytes after decompression
+    int buffer_size;
+
+    /// @brief Bytes of the file read from the cartridge so far
+    int bytes_read;
+
+    /// @brief Bytes of the QOI file that can be decoded so far
+    int bytes_ready;
+
+    /// @brief Next output row to decode
+    int row;
+
+    /// @brief Number of output rows to decode
+    int rows;
+
+    /// @brief Pixels from the start of one row of the raw image buffer to the next
+    int stride;
+
+    /// @brief Column of the raw image buffer the decoded image starts at
+    int originX;
+
+    /// @brief Row of the raw image buffer the decoded image starts at
+    int originY;
+
+    /// @brief Pointer to a raw image buffer
+    uint8_t* bytes;
+
+    /// @brief QOI decoding info as a result of decoding qoi file
+    qoi_img_info_t* info;
+
+    /// @brief Name of the QOI file
+    char name[256];
+
+    /// @brief Ticks spent working on this job across all slices
+    long long ticks;
+
+    /// @brief Ticks spent reading the file from the cartridge or waiting for it to land
+    long long readTicks;
+
+    /// @brief Ticks spent decompressing a QOI-LZ file
+    long long inflateTicks;
+
+    /// @brief Whether the header was read and the decoder is set up
+    bool decoding;
+
+    /// @brief Start of the output not yet written back from the data cache to RDRAM
+    uint8_t* flushStart;
+
+    /// @brief End of the output written so far
+    uint8_t* flushEnd;
+
+    /// @brief Data cache lines of the output claimed without reading them from RDRAM
+    int claimedLines;
+
+    /// @brief Whether a QOI file is being decoded
+    bool active;
+} qoi_decode_job_t;
+
+/// @brief The QOI file currently being decoded
+static qoi_decode_job_t job = {.active = false};
+
+/// @brief Texture formats matching each output format of the QOI decoder
+static const tex_format_t output_tex_formats[QOI_OUTPUT_FORMATS] = {
+    FMT_RGBA32,
+    FMT_RGBA16,
+    FMT_I8,
+    FMT_IA8,
+    FMT_RGBA32,
+    FMT_RGBA16
+};
+
+/// @brief Output formats that write colors which are already premultiplied the same way as each output format
+static const uint8_t straight_output_formats[QOI_OUTPUT_FORMATS] = {
+    QOI_OUTPUT_RGBA32,
+    QOI_OUTPUT_RGBA16,
+    QOI_OUTPUT_I8,
+    QOI_OUTPUT_IA8,
+    QOI_OUTPUT_RGBA32,
+    QOI_OUTPUT_RGBA16
+};
+
+/// @brief Number of slots in the table looking up palette indices. Twice the largest palette keeps probes short
+#define PALETTE_SLOTS (MAX_PALETTE_SIZE * 2)
+
+/// @brief Size in bytes of a line of the VR4300 data cache
+#define DCACHE_LINE_SIZE 16
+
+/// @brief Bytes of output written back to RDRAM at once. The size of the data cache as no more of the output can still be in it
+#define WRITEBACK_BATCH 8192
+
+/// @brief Claims the data cache lines fully inside an area without reading them from RDRAM first
+/// @details Claimed lines hold whatever was in the cache before so every byte of the area has to be written afterwards
+/// @param start Start of the area
+/// @param size Size of the area in bytes
+/// @return Number of lines claimed
+static int claim_cache_lines(uint8_t* start, size_t size) {
+#if QOI_DEC_CLAIM_OUTPUT_LINES && defined(__mips__)
+    uintptr_t line = ((uintptr_t)start + DCACHE_LINE_SIZE - 1) & ~(uintptr_t)(DCACHE_LINE_SIZE - 1);
+    uintptr_t end = (uintptr_t)start + size;
+    int lines = 0;
+
+    for (; line + DCACHE_LINE_SIZE <= end; line += DCACHE_LINE_SIZE) {
+        // Create Dirty Exclusive marks the line as holding the address without a read from RDRAM
+        __asm__ volatile ("cache 0x0D, 0(%0)" : : "r"(line) : "memory");
+        lines++;
+    }
+
+    return lines;
+#else
+    (void)start;
+    (void)size;
+
+    return 0;
+#endif
+}
+
+/// @brief Writes the output decoded since the last call back from the data cache to RDRAM for the RDP to read
+/// @param decode_job Decoding job the output belongs to
+/// @param force Whether to write back less than WRITEBACK_BATCH bytes
+static void writeback_output(qoi_decode_job_t* decode_job, bool force) {
+    size_t size = decode_job->flushEnd - decode_job->flushStart;
+
+    if (size > 0 && (force || size >= WRITEBACK_BATCH)) {
+        data_cache_hit_writeback(decode_job->flushStart, size);
+        decode_job->flushStart = decode_job->flushEnd;
+    }
+}
+
+/// @brief Decodes a row of a QOI image at full resolution
+/// @param decode_job Decoding job the row belongs to
+/// @param row Pointer to the start of the row in a raw image buffer
+static void decode_row(qoi_decode_job_t* decode_job, uint8_t* row) {
+    int bytes_per_pixel = QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT];
+    size_t width = decode_job->desc.width;
+    size_t written;
+
+    // the whole row is overwritten so its old contents never have to be read from RDRAM
+    decode_job->claimedLines += claim_cache_lines(row, width * bytes_per_pixel);
+
+    // runs are written as a block of pixels instead of one pixel at a time
+    written = decode_job->decodeSpan(&decode_job->dec, row, width);
+
+    // a truncated file would leave the rest of the claimed lines holding garbage
+    if (written < width) {
+        memset(row + written * bytes_per_pixel, 0, (width - written) * bytes_per_pixel);
+    }
+}
+
+/// @brief Decodes the next full resolution row as RGBA32 and undoes its row filter
+/// @param decode_job Decoding job the row belongs to
+/// @param cur Memory for the row
+/// @param above Full resolution row above as RGBA32 or NULL for the first row
+/// @return Pointer to the decoded row
+static qoi_pixel_t* decode_source_row(qoi_decode_job_t* decode_job, uint32_t* cur, const uint32_t* above) {
+    decode_job->sourceSpan(&decode_job->dec, cur, decode_job->desc.width);
+
+    // the inverse filter runs while the row is still in the data cache
+    if (decode_job->filters) {
+        qoi_unfilter_row(cur, above, decode_job->desc.width, decode_job->filters[decode_job->sourceRow]);
+    }
+
+    decode_job->sourceRow++;
+
+    return (qoi_pixel_t*)cur;
+}
+
+/// @brief Decodes the next full resolution row into the scratch rows of a decoding job
+/// @param decode_job Decoding job the row belongs to
+/// @return Pointer to the decoded row
+static qoi_pixel_t* decode_scratch_row(qoi_decode_job_t* decode_job) {
+    int y = decode_job->sourceRow;
+    uint32_t* above = y > 0 ? decode_job->sourceRows[(y - 1) & 1] : NULL;
+
+    return decode_source_row(decode_job, decode_job->sourceRows[y & 1], above);
+}
+
+/// @brief Decodes a row of a QOI-plus image at full resolution
+/// @param decode_job Decoding job the row belongs to
+/// @param row Pointer to the start of the row in a raw image buffer
+static void decode_filtered_row(qoi_decode_job_t* decode_job, uint8_t* row) {
+    uint32_t width = decode_job->desc.width;
+
+    if (QOI_DEC_OUTPUT_FORMAT == QOI_OUTPUT_RGBA32 && !decode_job->transfer) {
+        // the row above in the image buffer is already unfiltered so no scratch row is needed
+        const uint32_t* above = decode_job->sourceRow > 0 ? (const uint32_t*)row - decode_job->stride : NULL;
+
+        decode_source_row(decode_job, (uint32_t*)row, above);
+    }
+    else {
+        qoi_convert_pixels_transfer(decode_scratch_row(decode_job), row, width, QOI_DEC_OUTPUT_FORMAT, decode_job->transfer);
+    }
+}
+
+/// @brief Decodes enough rows of a QOI image to box filter one row down by a power of two
+/// @param decode_job Decoding job the row belongs to
+/// @param row Pointer to the start of the output row in a raw image buffer
+static void decode_downscaled_row(qoi_decode_job_t* decode_job, uint8_t* row) {
+    int shift = decode_job->info->downscaleShift;
+    int out_width = decode_job->desc.width >> shift;
+    int block = 1 << shift;
+    uint16_t* sums = decode_job->sums;
+    qoi_pixel_t* averages = decode_job->averages;
+
+    sys_hw_memset(sums, 0, out_width * 4 * sizeof(uint16_t));
+
+    for (int y = 0; y < block && !qoi_dec_done(&decode_job->dec); y++) {
+        qoi_pixel_t* src = decode_scratch_row(decode_job);
+
+        // columns past the last whole block are dropped
+        for (int x = 0; x < out_width << shift; x++) {
+            uint16_t* sum = &sums[(x >> shift) * 4];
+
+            // transparent pixels must not bleed their colors into the average
+            // the source row stays as it is since a QOI-plus file needs it to undo the filter of the next row
+            qoi_pixel_t px = QOI_OUTPUT_PREMULTIPLIED[QOI_DEC_OUTPUT_FORMAT] ? qoi_premultiply(src[x]) : src[x];
+
+            sum[0] += px.red;
+            sum[1] += px.green;
+            sum[2] += px.blue;
+            sum[3] += px.alpha;
+        }
+    }
+
+    for (int out_x = 0; out_x < out_width; out_x++) {
+        uint16_t* sum = &sums[out_x * 4];
+
+        qoi_set_pixel_rgba(
+            &averages[out_x],
+            sum[0] >> (shift * 2),
+            sum[1] >> (shift * 2),
+            sum[2] >> (shift * 2),
+            sum[3] >> (shift * 2)
+        );
+    }
+
+    qoi_convert_pixels_transfer(averages, row, out_width, straight_output_formats[QOI_DEC_OUTPUT_FORMAT], decode_job->transfer);
+}
+
+/// @brief Steps over a full resolution row above the region of a cropped image
+/// @param decode_job Decoding job the row belongs to
+static void skip_source_row(qoi_decode_job_t* decode_job) {
+    // undoing the row filter of the first row of the region needs the row above it
+    if (decode_job->filters) {
+        decode_scratch_row(decode_job);
+        return;
+    }
+
+    qoi_skip_pixels(&decode_job->dec, decode_job->desc.width);
+    decode_job->sourceRow++;
+}
+
+/// @brief Decodes the part of a full resolution row inside the region of a cropped image
+/// @param decode_job Decoding job the row belongs to
+/// @param row Pointer to the start of the row in a raw image buffer
+static void decode_region_row(qoi_decode_job_t* decode_job, uint8_t* row) {
+    const qoi_region_t* region = &decode_job->region;
+    int bytes_per_pixel = QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT];
+    size_t written;
+
+    if (decode_job->filters) {
+        qoi_convert_pixels_transfer(decode_scratch_row(decode_job) + region->x, row, region->width, QOI_DEC_OUTPUT_FORMAT, decode_job->transfer);
+        return;
+    }
+
+    decode_job->claimedLines += claim_cache_lines(row, region->width * bytes_per_pixel);
+
+    // pixels left and right of the region still move the decoder along but are never written
+    qoi_skip_pixels(&decode_job->dec, region->x);
+    written = decode_job->decodeSpan(&decode_job->dec, row, region->width);
+
+    if (written < region->width) {
+        memset(row + written * bytes_per_pixel, 0, (region->width - written) * bytes_per_pixel);
+    }
+
+    decode_job->sourceRow++;
+
+    // the stream after the last row of the region is never read
+    if (decode_job->sourceRow < (int)(region->y + region->height)) {
+        qoi_skip_pixels(&decode_job->dec, decode_job->desc.width - region->x - region->width);
+    }
+}
+
+/// @brief Gets the first full resolution row that goes into a row of a thumbnail
+/// @param decode_job Decoding job making the thumbnail
+/// @param row Row of the thumbnail. The height of the thumbnail gives the row past the last one
+/// @return Row of the QOI image
+static int get_thumbnail_source_row(qoi_decode_job_t* decode_job, int row) {
+    return (int)((int64_t)row * decode_job->desc.height / decode_job->info->height);
+}
+
+/// @brief Decodes the rows of a QOI image that make up one row of a thumbnail and averages them
+/// @details The thumbnail can be any size smaller than the image, so every thumbnail pixel averages
+/// the block of image pixels under it. Transparent parts are put over the background of the viewer
+/// @param decode_job Decoding job making the thumbnail
+/// @param row Pointer to the start of the thumbnail row
+static void decode_thumbnail_row(qoi_decode_job_t* decode_job, uint8_t* row) {
+    int width = decode_job->desc.width;
+    int out_width = decode_job->info->width;
+    int first = get_thumbnail_source_row(decode_job, decode_job->row);
+    int last = get_thumbnail_source_row(decode_job, decode_job->row + 1);
+    uint32_t* sums = decode_job->thumbnailSums;
+    qoi_pixel_t* averages = decode_job->averages;
+    color_t background = QOI_DEC_BACKGROUND == QOI_BACKGROUND_NONE ? RGBA32(0, 0, 0, 255) : QOI_DEC_BACKGROUND_COLOR;
+
+    sys_hw_memset(sums, 0, out_width * 4 * sizeof(uint32_t));
+
+    for (int y = first; y < last && !qoi_dec_done(&decode_job->dec); y++) {
+        qoi_pixel_t* src = decode_scratch_row(decode_job);
+        int x = 0;
+
+        for (int out_x = 0; out_x < out_width; out_x++) {
+            uint32_t* sum = &sums[out_x * 4];
+            int end = (int)((int64_t)(out_x + 1) * width / out_width);
+
+            for (; x < end; x++) {
+                sum[0] += src[x].red * src[x].alpha;
+                sum[1] += src[x].green * src[x].alpha;
+                sum[2] += src[x].blue * src[x].alpha;
+                sum[3] += src[x].alpha;
+            }
+        }
+    }
+
+    for (int out_x = 0, x = 0; out_x < out_width; out_x++) {
+        uint32_t* sum = &sums[out_x * 4];
+        int end = (int)((int64_t)(out_x + 1) * width / out_width);
+
+        // what the block does not cover with alpha is covered by the background
+        uint32_t total = (uint32_t)(end - x) * (last - first) * 255;
+        uint32_t uncovered = total - sum[3];
+
+        qoi_set_pixel_rgba(
+            &averages[out_x],
+            (sum[0] + background.r * uncovered) / total,
+            (sum[1] + background.g * uncovered) / total,
+            (sum[2] + background.b * uncovered) / total,
+            255
+        );
+
+        x = end;
+    }
+
+    qoi_convert_pixels_transfer(averages, row, out_width, QOI_OUTPUT_RGBA16, decode_job->transfer);
+}
+
+/// @brief Finds the palette index of a color and adds the color to the palette if it is new
+/// @param decode_job Decoding job the palette belongs to
+/// @param color Color as RGBA32
+/// @return Palette index of the color or -1 if the palette is full
+static int find_palette_index(qoi_decode_job_t* decode_job, uint32_t color) {
+    uint32_t slot = (color * 2654435761u) >> 23;
+
+    while (decode_job->paletteSlots[slot]) {
+        int index = decode_job->paletteSlots[slot] - 1;
+
+        if (decode_job->paletteColors[index] == color) {
+            return index;
+        }
+
+        slot = (slot + 1) & (PALETTE_SLOTS - 1);
+    }
+
+    if (decode_job->paletteSize >= MAX_PALETTE_SIZE) {
+        return -1;
+    }
+
+    decode_job->paletteColors[decode_job->paletteSize] = color;
+    decode_job->paletteSlots[slot] = ++decode_job->paletteSize;
+
+    return decode_job->paletteSize - 1;
+}
+
+/// @brief Turns the rows decoded as palette indices so far back into the output format
+/// @param decode_job Decoding job the rows belong to
+/// @param src Row being decoded when the palette ran out as RGBA32
+static void expand_indexed_rows(qoi_decode_job_t* decode_job, const qoi_pixel_t* src) {
+    int width = decode_job->desc.width;
+    int bytes_per_pixel = QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT];
+    uint8_t* bytes = decode_job->bytes;
+
+    qoi_convert_pixels_transfer(src, bytes + decode_job->row * width * bytes_per_pixel, width, QOI_DEC_OUTPUT_FORMAT, decode_job->transfer);
+
+    // going backwards every index is read before the pixels growing out of the ones before it overwrite it
+    for (int i = decode_job->row * width - 1; i >= 0; i--) {
+        qoi_convert_pixels_transfer(
+            (const qoi_pixel_t*)&decode_job->paletteColors[bytes[i]],
+            bytes + i * bytes_per_pixel,
+            1,
+            QOI_DEC_OUTPUT_FORMAT,
+            decode_job->transfer
+        );
+    }
+
+    decode_job->indexed = false;
+}
+
+/// @brief Decodes a row of a QOI image as palette indices
+/// @details Falls back to the output format for the rest of the image once the image has too many colors
+/// @param decode_job Decoding job the row belongs to
+static void decode_indexed_row(qoi_decode_job_t* decode_job) {
+    int width = decode_job->desc.width;
+    const uint32_t* src = (const uint32_t*)decode_scratch_row(decode_job);
+    uint8_t* row = decode_job->bytes + decode_job->row * width;
+
+    // runs and flat areas repeat the color before them so most pixels skip the table
+    uint32_t last_color = src[0] + 1;
+    int last_index = 0;
+
+    for (int x = 0; x < width; x++) {
+        if (src[x] != last_color) {
+            last_color = src[x];
+            last_index = find_palette_index(decode_job, last_color);
+
+            if (last_index < 0) {
+                expand_indexed_rows(decode_job, (const qoi_pixel_t*)src);
+                return;
+            }
+        }
+
+        row[x] = last_index;
+    }
+}
+
+/// @brief Gets the offset in a raw image buffer of the palette of a CI4 or CI8 image
+/// @param area Number of pixels of the image
+/// @return Offset in bytes right after the CI8 indices, aligned for the RDP to load the palette
+static size_t get_palette_offset(int area) {
+    return ((size_t)area + 15) & ~(size_t)15;
+}
+
+/// @brief Stores the palette of an image decoded as palette indices and packs the indices into CI4 if they fit
+/// @param decode_job Decoding job of the image
+static void finish_indexed_image(qoi_decode_job_t* decode_job) {
+    qoi_img_info_t* info = decode_job->info;
+    uint8_t* bytes = decode_job->bytes;
+    int area = info->width * info->height;
+    uint16_t* palette = (uint16_t*)(bytes + get_palette_offset(area));
+
+    qoi_convert_pixels_transfer(
+        (const qoi_pixel_t*)decode_job->paletteColors,
+        (uint8_t*)palette,
+        decode_job->paletteSize,
+        QOI_OUTPUT_PREMULTIPLIED[QOI_DEC_OUTPUT_FORMAT] ? QOI_OUTPUT_RGBA16_PREMULTIPLIED : QOI_OUTPUT_RGBA16,
+        decode_job->transfer
+    );
+
+    info->format = FMT_CI8;
+
+    // odd widths would leave rows starting halfway into a byte
+    if (decode_job->paletteSize <= 16 && (info->width & 1) == 0) {
+        // the first pixel of each pair goes in the high bits
+        for (int i = 0; i < area; i += 2) {
+            bytes[i >> 1] = (bytes[i] << 4) | bytes[i + 1];
+        }
+
+        info->format = FMT_CI4;
+    }
+
+    info->palette = palette;
+    info->paletteSize = decode_job->paletteSize;
+
+    // the packed indices are written back with the rest of the output
+    decode_job->flushStart = bytes;
+    decode_job->flushEnd = bytes + (info->format == FMT_CI4 ? area >> 1 : area);
+    data_cache_hit_writeback(palette, decode_job->paletteSize * sizeof(uint16_t));
+
+    debugf(
+        "%s: %d colors, shown as %s\n",
+        decode_job->name,
+        decode_job->paletteSize,
+        info->format == FMT_CI4 ? "CI4" : "CI8"
+    );
+}
+
+#if QOI_DEC_PROFILE_DECODER
+/// @brief Prints the chunks counted while decoding an image over the debug log for qoi_profile_report
+/// @param name Name of the image
+static void report_profile(const char* name) {
+    static const char* op_names[QOI_PROFILE_OPS] = {"rgb", "rgba", "index", "diff", "luma", "run", "hash", "fill", "store"};
+    qoi_profile_t counted = qoi_profile;
+
+    // the same counting with nothing in between measures what the counting itself costs
+    QOI_PROFILE_START(clock);
+
+    for (int i = 0; i < 64; i++) {
+        QOI_PROFILE_STOP(clock, QOI_PROFILE_RGB);
+    }
+
+    debugf("qoi_profile overhead %d %lu %s\n", 64, (unsigned long)(qoi_profile.ticks[QOI_PROFILE_RGB] - counted.ticks[QOI_PROFILE_RGB]), name);
+
+    for (int op = 0; op < QOI_PROFILE_OPS; op++) {
+        debugf("qoi_profile %s %lu %lu %s\n", op_names[op], (unsigned long)counted.chunks[op], (unsigned long)counted.ticks[op], name);
+    }
+}
+#endif
+
+/// @brief Gets the power of two an image has to be downscaled by to fit on screen
+/// @param width Width of the QOI image as stored in the file
+/// @param height Height of the QOI image as stored in the file
+/// @return Power of two to downscale the image by
+static int get_downscale_shift(uint32_t width, uint32_t height) {
+    int shift = 0;
+
+    // images bigger than the screen are box filtered down while decoding
+    // so the full resolution image never has to fit in memory
+    while ((width >> shift) > SCREEN_WIDTH || (height >> shift) > SCREEN_HEIGHT) {
+        shift++;
+    }
+
+    return shift;
+}
+
+/// @brief Picks the table converting the colors of an image into the colorspace of the framebuffer
+/// @param colorspace Colorspace from the header of the QOI file
+/// @return Table for the color channels or NULL if the image already matches the framebuffer
+static const uint8_t* get_transfer_table(uint8_t colorspace) {
+    // the video interface only applies gamma to the framebuffer when gamma correction is on
+    uint8_t display = QOI_DEC_DISPLAY_GAMMA == GAMMA_NONE ? QOI_SRGB : QOI_LINEAR;
+    uint8_t image = colorspace == QOI_LINEAR ? QOI_LINEAR : QOI_SRGB;
+
+    if (image == display) {
+        return NULL;
+    }
+
+    return display == QOI_LINEAR ? QOI_SRGB_TO_LINEAR : QOI_LINEAR_TO_SRGB;
+}
+
+/// @brief Reads the QOI header and prepares the decoder once the whole file is read
+/// @return QOI_OK if the image can be decoded
+static qoi_error_code setup_decoder() {
+    qoi_img_info_t* info = job.info;
+
+    size_t header_size = 14;
+
+    qoi_desc_init(&job.desc);
+    job.filters = NULL;
+
+#if QOI_DEC_PROFILE_DECODER
+    memset(&qoi_profile, 0, sizeof(qoi_profile));
+#endif
+
+    if (job.bytes_ready < 14) {
+        return QOI_INVAILD_FILE;
+    }
+
+    if (read_qoi_plus_header(&job.desc, job.qoi_bytes)) {
+        header_size = qoi_plus_header_size(&job.desc);
+
+        if ((size_t)job.buffer_size < header_size) {
+            return QOI_INVAILD_FILE;
+        }
+
+        job.filters = job.qoi_bytes + 14;
+    }
+    else if (!read_qoi_header(&job.desc, job.qoi_bytes)) {
+        return QOI_INVAILD_FILE;
+    }
+
+    info->srcWidth = job.desc.width;
+    info->srcHeight = job.desc.height;
+    info->channels = job.desc.channels;
+    info->colorspace = job.desc.colorspace;
+
+    job.transfer = get_transfer_table(job.desc.colorspace);
+
+    // thumbnails are box filtered by any amount instead of a power of two
+    // and a cropped image is decoded at full resolution
+    info->downscaleShift = job.thumbnail || job.cropped ? 0 : get_downscale_shift(job.desc.width, job.desc.height);
+
+    if (info->downscaleShift > MAX_DOWNSCALE_SHIFT) {
+        return QOI_TOO_BIG;
+    }
+
+    info->width = job.desc.width >> info->downscaleShift;
+    info->height = job.desc.height >> info->downscaleShift;
+
+    if (job.thumbnail) {
+        // the thumbnail keeps the aspect ratio of the image and is never bigger than it
+        if (info->width > QOI_THUMBNAIL_WIDTH) {
+            info->height = (int)((int64_t)info->height * QOI_THUMBNAIL_WIDTH / info->width);
+            info->width = QOI_THUMBNAIL_WIDTH;
+        }
+
+        if (info->height > QOI_THUMBNAIL_HEIGHT) {
+            info->width = (int)((int64_t)info->width * QOI_THUMBNAIL_HEIGHT / info->height);
+            info->height = QOI_THUMBNAIL_HEIGHT;
+        }
+
+        info->width = info->width > 0 ? info->width : 1;
+        info->height = info->height > 0 ? info->height : 1;
+
+        // the sums of the biggest block of pixels averaged must fit in 32 bits
+        if ((job.desc.width / info->width + 1) * (job.desc.height / info->height + 1) > 65535) {
+            return QOI_TOO_BIG;
+        }
+    }
+
+    if (job.cropped) {
+        qoi_region_t* region = &job.region;
+
+        // the region is cut to the image and moved back inside it if it reaches past an edge
+        region->width = region->width < job.desc.width ? region->width : job.desc.width;
+        region->height = region->height < job.desc.height ? region->height : job.desc.height;
+        region->x = region->x < job.desc.width - region->width ? region->x : job.desc.width - region->width;
+        region->y = region->y < job.desc.height - region->height ? region->y : job.desc.height - region->height;
+
+        if (region->width == 0 || region->height == 0 || region->width > SCREEN_WIDTH || region->height > SCREEN_HEIGHT) {
+            return QOI_TOO_BIG;
+        }
+
+        info->width = region->width;
+        info->height = region->height;
+    }
+
+    job.rows = info->height;
+    job.stride = info->width;
+
+    // frames are decoded at full resolution into their area of the canvas
+    if (job.anim) {
+        qoi_anim_t* anim = job.anim;
+
+        if (info->downscaleShift > 0 ||
+            info->width != anim->dirtyWidth ||
+            info->height != anim->dirtyHeight ||
+            job.originX + info->width > anim->width ||
+            job.originY + info->height > anim->height
+        ) {
+            return QOI_INVAILD_FILE;
+        }
+
+        job.stride = anim->width;
+
+        info->width = info->srcWidth = anim->width;
+        info->height = info->srcHeight = anim->height;
+    }
+
+    info->format = job.thumbnail ? FMT_RGBA16 : output_tex_formats[QOI_DEC_OUTPUT_FORMAT];
+
+    // a palette only saves memory over a texture format of more than 8 bits per pixel
+    // and box filtered or animated images mix colors that were never in the file
+    job.indexed = QOI_DEC_INDEXED_OUTPUT &&
+        QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT] > 1 &&
+        info->downscaleShift == 0 &&
+        !job.anim &&
+        !job.thumbnail &&
+        !job.cropped;
+    job.paletteSize = 0;
+
+    if (job.indexed) {
+        job.paletteColors = (uint32_t*)arena_alloc(&viewer_arena, MAX_PALETTE_SIZE * sizeof(uint32_t));
+        job.paletteSlots = (uint16_t*)arena_alloc(&viewer_arena, PALETTE_SLOTS * sizeof(uint16_t));
+
+        if (!job.paletteColors || !job.paletteSlots) {
+            return QOI_OUT_OF_MEMORY;
+        }
+
+        sys_hw_memset(job.paletteSlots, 0, PALETTE_SLOTS * sizeof(uint16_t));
+    }
+
+    if (job.thumbnail) {
+        job.thumbnailSums = (uint32_t*)arena_alloc(&viewer_arena, info->width * 4 * sizeof(uint32_t));
+        job.averages = (qoi_pixel_t*)arena_alloc(&viewer_arena, info->width * sizeof(qoi_pixel_t));
+
+        if (!job.thumbnailSums || !job.averages) {
+            return QOI_OUT_OF_MEMORY;
+        }
+    }
+
+    if (info->downscaleShift > 0) {
+        job.sums = (uint16_t*)arena_alloc(&viewer_arena, info->width * 4 * sizeof(uint16_t));
+        job.averages = (qoi_pixel_t*)arena_alloc(&viewer_arena, info->width * sizeof(qoi_pixel_t));
+
+        if (!job.sums || !job.averages) {
+            return QOI_OUT_OF_MEMORY;
+        }
+    }
+
+    // box filtering, palette lookups and undoing row filters need full resolution rows as RGBA32
+    // a QOI file only needs one since the row above is not used
+    if (info->downscaleShift > 0 ||
+        job.indexed ||
+        job.thumbnail ||
+        (job.filters && (job.cropped || job.transfer || QOI_DEC_OUTPUT_FORMAT != QOI_OUTPUT_RGBA32))
+    ) {
+        size_t row_size = job.desc.width * sizeof(uint32_t);
+
+        job.sourceRows[0] = (uint32_t*)arena_alloc(&viewer_arena, row_size);
+        job.sourceRows[1] = job.filters ? (uint32_t*)arena_alloc(&viewer_arena, row_size) : job.sourceRows[0];
+
+        if (!job.sourceRows[0] || !job.sourceRows[1]) {
+            return QOI_OUT_OF_MEMORY;
+        }
+    }
+
+    // the channel and output format checks happen once here instead of for every pixel
+    // the colorspace is converted as the pixels are written so the image is never gone over twice
+    job.decodeSpan = job.transfer ?
+        qoi_select_transfer_span_decoder(job.desc.channels, QOI_DEC_OUTPUT_FORMAT) :
+        qoi_select_span_decoder(job.desc.channels, QOI_DEC_OUTPUT_FORMAT);
+    job.sourceSpan = qoi_select_span_decoder(job.desc.channels, QOI_OUTPUT_RGBA32);
+    job.sourceRow = 0;
+
+    job.dec = (qoi_dec_t){
+        .run = 0,
+        .pad = 0,
+        .pixel_seek = 0,
+        .img_area = job.desc.width * job.desc.height,
+        .qoi_len = job.buffer_size,
+        .data = job.qoi_bytes,
+        .offset = job.qoi_bytes + header_size,
+        .transfer = job.transfer
+
+    }; // somehow this compiles
+
+    for (uint8_t element = 0; element < 64; element++)
+        qoi_initalize_pixel(&job.dec.buffer[element]);
+
+    qoi_set_pixel_rgba(&job.dec.prev_pixel, 0, 0, 0, 255);
+
+    return QOI_OK;
+}
+
+/// @brief Stops reading the file of the current decoding job and closes it if the job owns it
+static void close_job_file() {
+    // the PI must be done writing into the file buffer before the arena hands it out again
+    qoi_load_cancel(&job.load);
+
+    if (job.fp && job.ownsFile) {
+        fclose(job.fp);
+    }
+
+    job.fp = NULL;
+}
+
+/// @brief Ends the current decoding job and releases its memory
+/// @param error Error code as the result of decoding
+static void finish_job(qoi_error_code error) {
+    qoi_img_info_t* info = job.info;
+
+    close_job_file();
+
+    info->palette = NULL;
+    info->paletteSize = 0;
+
+    // the palette is copied out of the arena before it is released
+    if (error == QOI_OK && job.indexed) {
+        finish_indexed_image(&job);
+    }
+
+    // the RDP reads the image from RDRAM, not from the data cache
+    if (error == QOI_OK) {
+        writeback_output(&job, true);
+    }
 
-#include <assert.h>
+    // everything the job allocated is released at once
+    arena_reset(&viewer_arena, job.arenaMark);
+    job.qoi_bytes = NULL;
+    job.sums = NULL;
+    job.averages = NULL;
+    job.thumbnailSums = NULL;
+    job.sourceRows[0] = NULL;
+    job.sourceRows[1] = NULL;
+    job.filters = NULL;
+    job.packed = NULL;
+    job.paletteColors = NULL;
+    job.paletteSlots = NULL;
 
-/// @brief This function draws image decoded from QOI
-/// @param disp Surface image
-/// @param info QOI info for drawing image properly
-void draw_image(surface_t* disp, qoi_img_info_t info) {
-    const char rgbStr[] = "RGB";
-    const char rgbaStr[] = "RGBA";
-    const char unknownStr[] = "???";
-    const char* channelStr;
-    
-    surface_t image = surface_make_linear(
-        buffer0,
-        FMT_RGBA32,
-        info.width,
-        info.height
+    arena_report(&viewer_arena, "Viewer");
+    qoi_pool_report(&image_pool, "Image");
+
+    debugf(
+        "%s: read %d bytes in %lld us, decompressed in %lld us, %lld us in total, %d bytes of output not read from RDRAM\n",
+        job.name,
+        job.bytes_read,
+        TICKS_TO_US(job.readTicks),
+        TICKS_TO_US(job.inflateTicks),
+        TICKS_TO_US(job.ticks),
+        job.claimedLines * DCACHE_LINE_SIZE
     );
 
-    rdpq_attach(disp, NULL);
+#if QOI_DEC_PROFILE_DECODER
+    if (error == QOI_OK) {
+        report_profile(job.name);
+    }
+#endif
 
-    rdpq_set_mode_fill(RGBA32(0, 0, 0, 255));
-    rdpq_fill_rectangle(0, 0, 320, 240);
+    if (error == QOI_OK) {
+        sys_hw_memset(info->name, 0, 256);
+        memcpy(info->name, job.name, 256);
+        info->pixels = job.bytes;
+    }
 
-    rdpq_set_mode_standard();
+    info->error = error;
+    info->decodeTime = (float)((float)job.ticks / (float)TICKS_PER_SECOND);
+
+    job.active = false;
+}
+
+/// @brief Reads the next chunk of the file being decoded and decompresses it for QOI-LZ files
+/// @return QOI_NOT_INITIALIZED if the job can go on or the error that ends it
+static qoi_error_code read_next_chunk() {
+    long long start = timer_ticks();
+    bool ended;
+
+    // the next chunk is already on its way so all that is left is waiting for it
+    if (qoi_load_active(&job.load)) {
+        qoi_load_wait(&job.load);
+        job.readTicks += timer_ticks() - start;
+
+        return QOI_NOT_INITIALIZED;
+    }
 
-    // draw decoded image into screen
-    rdpq_tex_blit(&image, 0.0, 0.0, NULL);
+    if (job.packed) {
+        uint8_t header[QOI_LZ_BLOCK_HEADER_SIZE];
+        uint32_t packed_size, size;
 
-    if (info.renderDebugFont == true) {
-        if (info.channels == 3) {
-            channelStr = rgbStr;
-        } else if (info.channels == 4) {
-            channelStr = rgbaStr;
+        if (fread(header, 1, QOI_LZ_BLOCK_HEADER_SIZE, job.fp) != QOI_LZ_BLOCK_HEADER_SIZE ||
+            !qoi_lz_read_block_header(header, &packed_size, &size) ||
+            size > (uint32_t)(job.buffer_size - job.bytes_ready) ||
+            fread(job.packed, 1, packed_size, job.fp) != packed_size
+        ) {
+            return QOI_INVAILD_FILE;
         }
-        else {
-            channelStr = unknownStr;
+
+        job.bytes_read += QOI_LZ_BLOCK_HEADER_SIZE + packed_size;
+        job.readTicks += timer_ticks() - start;
+
+        start = timer_ticks();
+
+        // the block is decompressed right behind the blocks before it so matches can reach back into them
+        if (!qoi_lz_decompress_block(job.packed, packed_size, job.qoi_bytes + job.bytes_ready, size, job.qoi_bytes)) {
+            return QOI_INVAILD_FILE;
+        }
+
+        job.bytes_ready += size;
+        job.inflateTicks += timer_ticks() - start;
+
+        ended = job.bytes_ready >= job.buffer_size;
+    }
+    else {
+        int chunk = job.buffer_size - job.bytes_read;
+
+        if (chunk > READ_CHUNK_SIZE) {
+            chunk = READ_CHUNK_SIZE;
+        }
+
+        chunk = fread(job.qoi_bytes + job.bytes_read, 1, chunk, job.fp);
+
+        job.bytes_read += chunk;
+        job.bytes_ready = job.bytes_read;
+        job.readTicks += timer_ticks() - start;
+
+        ended = job.bytes_read >= job.buffer_size || chunk == 0;
+    }
+
+    if (ended) {
+        close_job_file();
+
+        // a file cut short is decoded as far as it goes
+        job.buffer_size = job.bytes_ready;
+        job.dec.qoi_len = job.bytes_ready;
+    }
+
+    return QOI_NOT_INITIALIZED;
+}
+
+/// @brief Makes a chunk of the QOI file that landed with PI DMA ready to decode
+/// @param user Decoding job the file belongs to
+/// @param data First byte of the chunk
+/// @param size Size of the chunk in bytes
+static void on_chunk_loaded(void* user, uint8_t* data, size_t size) {
+    qoi_decode_job_t* decode_job = (qoi_decode_job_t*)user;
+
+    (void)data;
+
+    // chunks land in order right behind the ones before them
+    decode_job->bytes_read += size;
+    decode_job->bytes_ready = decode_job->bytes_read;
+}
+
+/// @brief Checks if the file of the current decoding job is still being read
+/// @return true if more of the file is to come
+static bool is_reading() {
+    return job.fp || qoi_load_active(&job.load);
+}
+
+/// @brief Checks if enough of the QOI file is ready to decode the next output row
+/// @return true if the next output row can be decoded
+static bool is_row_ready() {
+    int rows = 1 << job.info->downscaleShift;
+    int needed;
+
+    if (job.thumbnail) {
+        rows = get_thumbnail_source_row(&job, job.row + 1) - get_thumbnail_source_row(&job, job.row);
+    }
+
+    needed = rows * job.desc.width * MAX_BYTES_PER_PIXEL;
+
+    return !is_reading() || job.bytes_ready - (int)(job.dec.offset - job.qoi_bytes) >= needed;
+}
+
+/// @brief Starts a decoding job reading an encoded image from an open file
+/// @param fp File positioned at the start of the encoded image
+/// @param size Size of the encoded image in bytes
+/// @param owns_file Whether the job closes the file once it is read
+/// @param name Name of the file
+/// @param bytes Pointer to a raw image buffer
+/// @param info QOI decoding info as a result of decoding qoi file
+/// @param start Ticks when work on the job started
+/// @return true if decoding started, false if info contains the error
+static bool begin_job(FILE* fp, int size, bool owns_file, const char* name, uint8_t* bytes, qoi_img_info_t* info, long long start) {
+    uint8_t header[QOI_LZ_HEADER_SIZE];
+    uint32_t wrapped_size;
+    uint32_t rom_address = 0;
+    long image_start = ftell(fp);
+    bool compressed = false;
+
+    job.fp = fp;
+    job.ownsFile = owns_file;
+    job.anim = NULL;
+    job.buffer_size = size;
+    job.bytes_read = 0;
+
+    // QOI-LZ files are decompressed into a buffer the size of the wrapped file
+    if (job.buffer_size >= QOI_LZ_HEADER_SIZE &&
+        fread(header, 1, QOI_LZ_HEADER_SIZE, job.fp) == QOI_LZ_HEADER_SIZE &&
+        qoi_lz_read_header(header, &wrapped_size)
+    ) {
+        compressed = true;
+        job.buffer_size = wrapped_size;
+        job.bytes_read = QOI_LZ_HEADER_SIZE;
+    }
+    else {
+        fseek(job.fp, image_start, SEEK_SET);
+
+        // the file lands with PI DMA while the CPU decodes what is already in. Frames of a
+        // QOI animation share its file and QOI-LZ blocks are read one at a time with fread
+        if (owns_file && (rom_address = qoi_load_find(name)) != 0) {
+            // the image may start partway into the file
+            rom_address += image_start;
+            rom_address = (rom_address & 1) ? 0 : rom_address;
         }
+    }
+
+    job.arenaMark = arena_mark(&viewer_arena);
+
+    // the PI may write one byte past an odd sized file
+    job.qoi_bytes = (uint8_t*)arena_alloc(&viewer_arena, (job.buffer_size + 1) * sizeof(uint8_t));
+    job.packed = compressed ? (uint8_t*)arena_alloc(&viewer_arena, QOI_LZ_BLOCK_SIZE) : NULL;
+    job.sums = NULL;
+    job.averages = NULL;
+    job.thumbnailSums = NULL;
+    job.sourceRows[0] = NULL;
+    job.sourceRows[1] = NULL;
+    job.filters = NULL;
+    job.paletteColors = NULL;
+    job.paletteSlots = NULL;
+    job.indexed = false;
+    job.thumbnail = false;
+    job.cropped = false;
+
+    if (!job.qoi_bytes || (compressed && !job.packed)) {
+        close_job_file();
+        arena_reset(&viewer_arena, job.arenaMark);
+        info->error = QOI_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // copy first 255 characters to prevent string overflow
+    sys_hw_memset(job.name, 0, 256);
+    memcpy(job.name, name, strlen(name) < 256 ? strlen(name) : 255);
+
+    job.bytes_ready = 0;
+    job.row = 0;
+    job.originX = 0;
+    job.originY = 0;
+    job.bytes = bytes;
+    job.info = info;
+    job.active = true;
+    job.ticks = timer_ticks() - start;
+    job.readTicks = job.ticks;
+    job.inflateTicks = 0;
+    job.decoding = false;
+    job.flushStart = bytes;
+    job.flushEnd = bytes;
+    job.claimedLines = 0;
+
+    if (rom_address) {
+        close_job_file();
+        qoi_load_begin(&job.load, rom_address, job.qoi_bytes, job.buffer_size, READ_CHUNK_SIZE, on_chunk_loaded, &job);
+    }
+
+    info->error = QOI_NOT_INITIALIZED;
+
+    return true;
+}
+
+/// @brief Gets the size of the raw image buffer an image is decoded into
+/// @details Covers the pixels in the output format and the palette after the indices when the image is shown as CI4 or CI8
+/// @param width Width of the image as shown in pixels
+/// @param height Height of the image as shown in pixels
+/// @return Size in bytes
+size_t getQOIBufferSize(int width, int height) {
+    size_t area = (size_t)width * height;
+    size_t size = area * QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT];
+    size_t indexed_size = get_palette_offset(area) + MAX_PALETTE_SIZE * sizeof(uint16_t);
+
+    if (QOI_DEC_INDEXED_OUTPUT && QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT] > 1 && indexed_size > size) {
+        size = indexed_size;
+    }
+
+    return size;
+}
+
+/// @brief Starts decoding a QOI file into a raw image buffer
+/// @param filename Name of the QOI file
+/// @param bytes Pointer to a raw image buffer
+/// @param info QOI decoding info as a result of decoding qoi file
+/// @return true if decoding started, false if info contains the error
+bool beginQOIDecode(const char* filename, uint8_t* bytes, qoi_img_info_t* info) {
+    long long start;
+    FILE* fp;
+    int size;
+
+    if (!bytes) {
+        info->error = QOI_NULL_BUFFER;
+        return false;
+    }
+
+    if (!filename) {
+        info->error = QOI_NO_FILENAME;
+        return false;
+    }
+
+    cancelQOIDecode();
+
+    start = timer_ticks();
+
+    fp = fopen(filename, "rb");
+
+    if (!fp) {
+        info->error = QOI_NO_FILE;
+        return false;
+    }
     
-        rdpq_text_printf(
-            &(rdpq_textparms_t) {
-                .width = 320-32,
-                .align = ALIGN_LEFT,
-                .wrap = WRAP_WORD,
-            }, 
-            1, 
-            32, 
-            32, 
-            "N64 QOI Viewer (Revised: %s)\n"
-            "Current Image: %s\n"
-            "Size: %i x %i\n"
-            "Channels: %i (%s)\n"
-            "Decode Time: %f ms",
-            QOI_DEC_REVISION_DATE,
-            info.name,
-            info.width,
-            info.height,
-            info.channels,
-            channelStr,
-            info.decodeTime * 1000.0f
-            );
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    return begin_job(fp, size, true, filename, bytes, info, start);
+}
+
+/// @brief Starts decoding only a rectangle of a QOI file at full resolution into a raw image buffer
+/// @param filename Name of the QOI file
+/// @param bytes Pointer to a raw image buffer
+/// @param info QOI decoding info as a result of decoding qoi file
+/// @param x Left edge of the rectangle in pixels of the QOI image
+/// @param y Top edge of the rectangle in pixels of the QOI image
+/// @param width Width of the rectangle, at most SCREEN_WIDTH
+/// @param height Height of the rectangle, at most SCREEN_HEIGHT
+/// @return true if decoding started, false if info contains the error
+bool beginQOIRegion(const char* filename, uint8_t* bytes, qoi_img_info_t* info, int x, int y, int width, int height) {
+    if (!beginQOIDecode(filename, bytes, info)) {
+        return false;
     }
 
-    rdpq_detach_show();
+    // the rectangle is fitted to the image once the header is read
+    job.cropped = true;
+    job.region = (qoi_region_t){
+        .x = x > 0 ? x : 0,
+        .y = y > 0 ? y : 0,
+        .width = width > 0 ? width : 0,
+        .height = height > 0 ? height : 0
+    };
+
+    return true;
+}
+
+/// @brief Continues decoding the QOI file started by beginQOIDecode()
+/// @param budget Ticks to spend before returning. 0 or less decodes the whole image
+/// @return true once no QOI file is left to decode
+bool stepQOIDecode(long long budget) {
+    long long start = timer_ticks();
+    qoi_error_code error = QOI_NOT_INITIALIZED;
+
+    if (!job.active) {
+        return true;
+    }
+
+    // work in chunks and rows so the time budget is checked often
+    do {
+        // chunks that landed since the last check become ready to decode
+        qoi_load_poll(&job.load);
+
+        if (!job.decoding) {
+            // decoding starts as soon as the header is in
+            if (job.bytes_ready >= 14 || !is_reading()) {
+                error = setup_decoder();
+
+                if (error != QOI_OK) {
+                    break;
+                }
+
+                error = QOI_NOT_INITIALIZED;
+                job.decoding = true;
+            }
+            else if (budget > 0 && qoi_load_active(&job.load)) {
+                // the header may still land before the slice ends
+                continue;
+            }
+            else if ((error = read_next_chunk()) != QOI_NOT_INITIALIZED) {
+                break;
+            }
+        }
+        else if (job.row >= job.rows || qoi_dec_done(&job.dec)) {
+            // rows past the last whole downscaled block or below the region are never shown
+            // so decoding stops here
+            error = QOI_OK;
+            break;
+        }
+        else if (job.cropped && job.sourceRow < (int)job.region.y && is_row_ready()) {
+            skip_source_row(&job);
+        }
+        else if (is_row_ready()) {
+            int bytes_per_pixel = job.thumbnail ? sizeof(uint16_t) : QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT];
+            uint8_t* row = job.bytes + ((job.originY + job.row) * job.stride + job.originX) * bytes_per_pixel;
+
+            if (job.thumbnail) {
+                decode_thumbnail_row(&job, row);
+            }
+            else if (job.cropped) {
+                decode_region_row(&job, row);
+            }
+            else if (job.indexed) {
+                decode_indexed_row(&job);
+            }
+            else if (job.info->downscaleShift > 0) {
+                decode_downscaled_row(&job, row);
+            }
+            else if (job.filters) {
+                decode_filtered_row(&job, row);
+            }
+            else {
+                decode_row(&job, row);
+            }
+
+            job.row++;
+
+            // indices are packed once the whole image is decoded so they are written back then
+            job.flushEnd = job.bytes + (job.originY + job.row) * job.stride * bytes_per_pixel;
+
+            if (!job.indexed) {
+                writeback_output(&job, false);
+            }
+        }
+        else if (budget > 0 && qoi_load_active(&job.load)) {
+            // the next chunk may still land before the slice ends
+            continue;
+        }
+        else if ((error = read_next_chunk()) != QOI_NOT_INITIALIZED) {
+            break;
+        }
+    } while (budget <= 0 || timer_ticks() - start < budget);
+
+    job.ticks += timer_ticks() - start;
+
+    if (error != QOI_NOT_INITIALIZED) {
+        finish_job(error);
+        return true;
+    }
+
+    return false;
 }
 
+/// @brief Stops decoding the QOI file started by beginQOIDecode() if any
+void cancelQOIDecode() {
+    if (job.active) {
+        finish_job(QOI_NOT_INITIALIZED);
+    }
+}
 
 /// @brief This function decodes QOI file from from into the framebuffer
 /// @param filename Name of the QOI file
 /// @param bytes Pointer to a raw image buffer
 /// @param info QOI decoding info as a result of decoding qoi file
 void openQOIFile(const char* filename, uint8_t* bytes, qoi_img_info_t* info) {
-    
-    qoi_desc_t desc;
-    qoi_dec_t dec;
-    qoi_pixel_t px;
-    uint8_t* qoi_bytes;
-    int seek = 0, buffer_size;
-    long long start, end;
+    if (beginQOIDecode(filename, bytes, info)) {
+        stepQOIDecode(0);
+    }
+}
+
+/// @brief Reads a big endian 16 bit value
+/// @param data Pointer to the first byte
+/// @return Value in native byte order
+static uint16_t read_be16(const uint8_t* data) {
+    return (data[0] << 8) | data[1];
+}
+
+/// @brief Reads a big endian 32 bit value
+/// @param data Pointer to the first byte
+/// @return Value in native byte order
+static uint32_t read_be32(const uint8_t* data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+/// @brief Copies an area from one raw image buffer to another
+/// @param src Raw image buffer to copy from
+/// @param dst Raw image buffer to copy to
+/// @param stride Pixels from the start of one row to the next
+/// @param x Left edge of the area
+/// @param y Top edge of the area
+/// @param width Width of the area
+/// @param height Height of the area
+static void copy_area(const uint8_t* src, uint8_t* dst, int stride, int x, int y, int width, int height) {
+    int bytes_per_pixel = QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT];
+
+    for (int row = y; row < y + height; row++) {
+        int offset = (row * stride + x) * bytes_per_pixel;
+
+        memcpy(dst + offset, src + offset, width * bytes_per_pixel);
+    }
+
+    if (width > 0 && height > 0) {
+        uint8_t* first = dst + (y * stride + x) * bytes_per_pixel;
+        uint8_t* last = dst + ((y + height - 1) * stride + x + width) * bytes_per_pixel;
+
+        data_cache_hit_writeback(first, last - first);
+    }
+}
+
+/// @brief Opens a QOI animation to play with beginQOIFrame()
+/// @param filename Name of the QOI animation file
+/// @param anim QOI animation to set up
+/// @return QOI_OK if the animation can be played
+qoi_error_code openQOIAnimation(const char* filename, qoi_anim_t* anim) {
+    uint8_t header[QOI_ANIM_HEADER_SIZE];
+
+    sys_hw_memset(anim, 0, sizeof(qoi_anim_t));
+
+    if (!filename) {
+        return QOI_NO_FILENAME;
+    }
+
+    anim->fp = fopen(filename, "rb");
+
+    if (!anim->fp) {
+        return QOI_NO_FILE;
+    }
+
+    if (fread(header, 1, QOI_ANIM_HEADER_SIZE, anim->fp) != QOI_ANIM_HEADER_SIZE ||
+        memcmp(header, QOI_ANIM_MAGIC, 4) != 0 ||
+        read_be32(&header[12]) == 0
+    ) {
+        closeQOIAnimation(anim);
+        return QOI_INVAILD_FILE;
+    }
+
+    anim->width = read_be32(&header[4]);
+    anim->height = read_be32(&header[8]);
+    anim->frameCount = read_be32(&header[12]);
+    anim->nextFrame = QOI_ANIM_HEADER_SIZE;
+
+    // frames are shown as they are so they are never downscaled
+    if (anim->width > SCREEN_WIDTH || anim->height > SCREEN_HEIGHT) {
+        closeQOIAnimation(anim);
+        return QOI_TOO_BIG;
+    }
+
+    memcpy(anim->name, filename, strlen(filename) < 256 ? strlen(filename) : 255);
+
+    return QOI_OK;
+}
+
+/// @brief Starts decoding the next frame of a QOI animation. Continue with stepQOIDecode()
+/// @param anim QOI animation opened with openQOIAnimation()
+/// @param shown Raw image buffer holding the frame on screen or NULL for the first frame
+/// @param bytes Raw image buffer to decode the frame into. The area changed by the frame on screen is copied over first
+/// @param info QOI decoding info as a result of decoding the frame
+/// @return true if decoding started, false if info contains the error
+bool beginQOIFrame(qoi_anim_t* anim, const uint8_t* shown, uint8_t* bytes, qoi_img_info_t* info) {
+    uint8_t record[QOI_ANIM_FRAME_HEADER_SIZE];
+    int x, y, width, height;
+    long long start;
+
+    if (!bytes) {
+        info->error = QOI_NULL_BUFFER;
+        return false;
+    }
+
+    if (!anim->fp) {
+        info->error = QOI_NO_FILE;
+        return false;
+    }
+
+    cancelQOIDecode();
+
+    start = timer_ticks();
+
+    // the animation loops back to the first frame
+    if (anim->frame >= anim->frameCount) {
+        anim->frame = 0;
+        anim->nextFrame = QOI_ANIM_HEADER_SIZE;
+    }
+
+    fseek(anim->fp, anim->nextFrame, SEEK_SET);
+
+    if (fread(record, 1, QOI_ANIM_FRAME_HEADER_SIZE, anim->fp) != QOI_ANIM_FRAME_HEADER_SIZE) {
+        info->error = QOI_INVAILD_FILE;
+        return false;
+    }
+
+    x = read_be16(&record[0]);
+    y = read_be16(&record[2]);
+    width = read_be16(&record[4]);
+    height = read_be16(&record[6]);
+
+    // the buffer being decoded into still holds the frame before the one on screen
+    // so the area the frame on screen changed is brought over first
+    // unless the new frame covers the whole canvas anyway
+    if (shown && shown != bytes && (width < anim->width || height < anim->height)) {
+        copy_area(shown, bytes, anim->width, anim->dirtyX, anim->dirtyY, anim->dirtyWidth, anim->dirtyHeight);
+    }
+
+    if (!begin_job(anim->fp, read_be32(&record[12]), false, anim->name, bytes, info, start)) {
+        return false;
+    }
+
+    job.anim = anim;
+    job.originX = x;
+    job.originY = y;
+    job.flushStart = bytes + y * anim->width * QOI_OUTPUT_BYTES[QOI_DEC_OUTPUT_FORMAT];
+    job.flushEnd = job.flushStart;
+
+    anim->dirtyX = x;
+    anim->dirtyY = y;
+    anim->dirtyWidth = width;
+    anim->dirtyHeight = height;
+    anim->delayMs = read_be16(&record[8]);
+
+    anim->nextFrame += QOI_ANIM_FRAME_HEADER_SIZE + read_be32(&record[12]);
+    anim->frame++;
+
+    return true;
+}
+
+/// @brief Stops a QOI animation and closes its file
+/// @param anim QOI animation opened with openQOIAnimation()
+void closeQOIAnimation(qoi_anim_t* anim) {
+    if (job.active && job.anim == anim) {
+        cancelQOIDecode();
+    }
 
+    if (anim->fp) {
+        fclose(anim->fp);
+        anim->fp = NULL;
+    }
+}
+
+/// @brief Starts shrinking a QOI file into a thumbnail. Continue with stepQOIDecode()
+/// @param filename Name of the QOI file or QOI animation
+/// @param bytes Memory for the thumbnail of QOI_THUMBNAIL_SIZE bytes
+/// @param info QOI decoding info as a result of making the thumbnail
+/// @return true if decoding started, false if info contains the error
+bool beginQOIThumbnail(const char* filename, uint8_t* bytes, qoi_img_info_t* info) {
+    uint8_t header[QOI_ANIM_HEADER_SIZE];
+    uint8_t record[QOI_ANIM_FRAME_HEADER_SIZE];
+    long long start;
     FILE* fp;
+    int size;
 
     if (!bytes) {
         info->error = QOI_NULL_BUFFER;
-        return;
+        return false;
     }
 
     if (!filename) {
         info->error = QOI_NO_FILENAME;
-        return;
+        return false;
     }
 
+    cancelQOIDecode();
+
     start = timer_ticks();
+
     fp = fopen(filename, "rb");
 
     if (!fp) {
         info->error = QOI_NO_FILE;
-        return;
+        return false;
     }
-    
+
     fseek(fp, 0, SEEK_END);
-    buffer_size = ftell(fp);
+    size = ftell(fp);
     fseek(fp, 0, SEEK_SET);
 
-    qoi_bytes = (uint8_t*)malloc(buffer_size * sizeof(uint8_t));
-    
-    assert(qoi_bytes); // crash if qoi_bytes fails to allocate
+    // the thumbnail of a QOI animation is made from its first frame, which covers the whole canvas
+    if (fread(header, 1, QOI_ANIM_HEADER_SIZE, fp) == QOI_ANIM_HEADER_SIZE && memcmp(header, QOI_ANIM_MAGIC, 4) == 0) {
+        if (fread(record, 1, QOI_ANIM_FRAME_HEADER_SIZE, fp) != QOI_ANIM_FRAME_HEADER_SIZE) {
+            fclose(fp);
+            info->error = QOI_INVAILD_FILE;
+            return false;
+        }
 
-    fread(qoi_bytes, 1, buffer_size, fp);
+        size = read_be32(&record[12]);
+    }
+    else {
+        fseek(fp, 0, SEEK_SET);
+    }
 
-    fclose(fp);
+    if (!begin_job(fp, size, true, filename, bytes, info, start)) {
+        return false;
+    }
 
-    fp = NULL;
+    job.thumbnail = true;
 
-    qoi_desc_init(&desc);
-    
-    if (!read_qoi_header(&desc, qoi_bytes)) {
-        info->error = QOI_INVAILD_FILE;
-        goto cleanup;
+    return true;
+}
+
+/// @brief Reads only the header of a QOI file to find out what decoding it involves
+/// @param filename Name of the QOI file
+/// @param probe Metadata read from the header of the QOI file
+void qoi_probe(const char* filename, qoi_probe_info_t* probe) {
+    qoi_desc_t desc;
+    uint8_t header[QOI_LZ_HEADER_SIZE];
+    uint8_t* qoi_header = header;
+    uint32_t wrapped_size;
+    size_t header_read;
+    FILE* fp;
+
+    sys_hw_memset(probe, 0, sizeof(qoi_probe_info_t));
+
+    if (!filename) {
+        probe->error = QOI_NO_FILENAME;
+        return;
     }
 
-    info->width = desc.width;
-    info->height = desc.height;
-    info->channels = desc.channels;
+    fp = fopen(filename, "rb");
 
-    assertf(
-        info->width * info->height * info->channels <= IMG_BUFFER_SIZE,
-        "%s is too big to open and read\n\
-        To prevent buffer overrun on big sized QOI images,\n\
-         QOI Viewer has been terminated.\n\
-        Make sure your QOI image is a maximum of 320 pixels\n\
-         in width and 240 pixels in height",
-        filename
-    ); // crash to prevent buffer overrun
+    if (!fp) {
+        probe->error = QOI_NO_FILE;
+        return;
+    }
 
-    dec = (qoi_dec_t){
-        .run = 0,
-        .pad = 0,
-        .pixel_seek = 0,
-        .img_area = desc.width * desc.height,
-        .qoi_len = buffer_size,
-        .data = qoi_bytes,
-        .offset = qoi_bytes + 14
+    fseek(fp, 0, SEEK_END);
+    probe->fileSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
 
-    }; // somehow this compiles
+    qoi_desc_init(&desc);
 
-    for (uint8_t element = 0; element < 64; element++)
-        qoi_initalize_pixel(&dec.buffer[element]);
+    header_read = fread(header, 1, QOI_LZ_HEADER_SIZE, fp);
 
-    qoi_set_pixel_rgba(&dec.prev_pixel, 0, 0, 0, 255);
+    // QOI animations are played at the size of their canvas
+    if (header_read >= QOI_ANIM_HEADER_SIZE && memcmp(header, QOI_ANIM_MAGIC, 4) == 0) {
+        fclose(fp);
 
-    while (!qoi_dec_done(&dec)) {
-        px = qoi_decode_chunk(&dec);
-        
-        // O2 still copy bytes so we use pointer trick to pretend
-        // that pixel data is an integer and copy 4 bytes at a time
-        *(uint32_t*)(bytes+seek) = px.concatenated_pixel_values;
-        
-        seek += 4;
+        probe->width = read_be32(&header[4]);
+        probe->height = read_be32(&header[8]);
+        probe->frameCount = read_be32(&header[12]);
 
+        if (probe->frameCount == 0) {
+            probe->error = QOI_INVAILD_FILE;
+        }
+        else if (probe->width > SCREEN_WIDTH || probe->height > SCREEN_HEIGHT) {
+            probe->error = QOI_TOO_BIG;
+        }
+        else {
+            probe->error = QOI_OK;
+        }
+
+        return;
     }
-    
-    sys_hw_memset(info->name, 0, 256);
 
-    // copy first 255 characters to prevent string overflow
-    memcpy(info->name, filename, strlen(filename) < 256 ? strlen(filename) : 255);
-    info->error = QOI_OK;
-
-cleanup:
-    free(qoi_bytes);
-    qoi_bytes = NULL;
-    end = timer_ticks();
-    info->decodeTime = (float)((float)(end - start) / (float)TICKS_PER_SECOND);
+    // QOI-LZ files keep a copy of the header of the wrapped file so nothing is decompressed here
+    if (header_read == QOI_LZ_HEADER_SIZE && qoi_lz_read_header(header, &wrapped_size)) {
+        qoi_header = &header[8];
+    }
+
+    // QOI-plus files have the same header fields followed by the row filters
+    if (header_read < 14 || (!read_qoi_header(&desc, qoi_header) && !read_qoi_plus_header(&desc, qoi_header))) {
+        fclose(fp);
+        probe->error = QOI_INVAILD_FILE;
+        return;
+    }
+
+    fclose(fp);
+
+    probe->width = desc.width;
+    probe->height = desc.height;
+    probe->channels = desc.channels;
+    probe->colorspace = desc.colorspace;
+    probe->downscaleShift = get_downscale_shift(desc.width, desc.height);
+
+    probe->error = probe->downscaleShift > MAX_DOWNSCALE_SHIFT ? QOI_TOO_BIG : QOI_OK;
 }
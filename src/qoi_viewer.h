@@ -40,14 +40,39 @@ extern "C" {
 #include "sQOI.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <libdragon.h>
 
-/// @brief Image buffer size: 320 pixels in width * 240 pixels in height * 4 channels
+/// @brief Width of the screen in pixels
+#define SCREEN_WIDTH 320
+
+/// @brief Height of the screen in pixels
+#define SCREEN_HEIGHT 240
+
+/// @brief Size of the biggest raw image buffer: 320 pixels in width * 240 pixels in height * 4 channels
+/// @details Raw image buffers are sized to each image with getQOIBufferSize()
 #define IMG_BUFFER_SIZE 307200
 
-extern uint8_t buffer0[IMG_BUFFER_SIZE];
+/// @brief Largest power of two shift the decoder may downscale an image by (1/8 scale)
+#define MAX_DOWNSCALE_SHIFT 3
+
+/// @brief Most colors an image can have to be decoded into a CI8 raw image buffer
+#define MAX_PALETTE_SIZE 256
+
+/// @brief Widest a thumbnail made by beginQOIThumbnail() can be in pixels
+#define QOI_THUMBNAIL_WIDTH 64
+
+/// @brief Tallest a thumbnail made by beginQOIThumbnail() can be in pixels
+#define QOI_THUMBNAIL_HEIGHT 48
 
-extern uint8_t buffer1[IMG_BUFFER_SIZE];
+/// @brief Size in bytes of the memory a thumbnail is decoded into as RGBA16
+#define QOI_THUMBNAIL_SIZE (QOI_THUMBNAIL_WIDTH * QOI_THUMBNAIL_HEIGHT * 2)
+
+/// @brief Columns of thumbnails on a page of the browser
+#define BROWSER_COLUMNS 4
+
+/// @brief Rows of thumbnails on a page of the browser
+#define BROWSER_ROWS 4
 
 /// @brief Error codes for different situations when handling a QOI file
 typedef enum qoi_error_code {
@@ -62,20 +87,68 @@ typedef enum qoi_error_code {
     /// @brief No file found given a filename to the supposed QOI image
     QOI_NO_FILE,
     /// @brief Filename to the QOI image not passed to decoder
-    QOI_NO_FILENAME
+    QOI_NO_FILENAME,
+    /// @brief QOI image does not fit on screen even when downscaled
+    QOI_TOO_BIG,
+    /// @brief Not enough memory left in the arena to decode the QOI image
+    QOI_OUT_OF_MEMORY
 } qoi_error_code;
 
+/// @brief How the decoded image is scaled onto the screen
+typedef enum qoi_zoom_mode {
+    /// @brief Show the decoded image pixel for pixel
+    QOI_ZOOM_ORIGINAL,
+    /// @brief Scale the image so all of it is visible on screen
+    QOI_ZOOM_FIT,
+    /// @brief Scale the image so it covers the whole screen
+    QOI_ZOOM_FILL,
+    /// @brief Scale the image by the largest whole number that fits on screen
+    QOI_ZOOM_INTEGER,
+    /// @brief Number of zoom modes
+    QOI_ZOOM_MODES
+} qoi_zoom_mode;
+
+/// @brief How the slideshow changes from one image to the next
+typedef enum qoi_transition {
+    /// @brief Fade the next image in over the current image
+    QOI_TRANSITION_CROSSFADE,
+    /// @brief Reveal the next image from left to right
+    QOI_TRANSITION_WIPE
+} qoi_transition_t;
+
+/// @brief What the transparent parts of RGBA images are shown over
+typedef enum qoi_background {
+    /// @brief The black screen
+    QOI_BACKGROUND_NONE,
+    /// @brief QOI_DEC_BACKGROUND_COLOR
+    QOI_BACKGROUND_COLOR,
+    /// @brief Squares of QOI_DEC_BACKGROUND_COLOR and QOI_DEC_CHECKERBOARD_COLOR
+    QOI_BACKGROUND_CHECKERBOARD
+} qoi_background_t;
+
 /// @brief Metadata about the QOI image and the QOI image viewer
 typedef struct qoi_img_info {
-    /// @brief Width of the QOI image
+    /// @brief Width of the decoded image
     int width;
 
-    /// @brief Height of the QOI image
+    /// @brief Height of the decoded image
     int height;
 
+    /// @brief Width of the QOI image as stored in the file
+    int srcWidth;
+
+    /// @brief Height of the QOI image as stored in the file
+    int srcHeight;
+
+    /// @brief Power of two the QOI image was downscaled by while decoding
+    int downscaleShift;
+
     /// @brief Number of channels of the QOI image where 3 is RGB and 4 is RGBA
     int channels;
 
+    /// @brief Colorspace of the QOI image where 0 is sRGB and 1 is linear
+    int colorspace;
+
     /// @brief Error code as the result of decoding
     qoi_error_code error;
 
@@ -85,21 +158,217 @@ typedef struct qoi_img_info {
     /// @brief Names of QOI file
     char name[256];
 
+    /// @brief Raw image buffer the QOI image was decoded into
+    uint8_t* pixels;
+
+    /// @brief Texture format of the raw image buffer
+    tex_format_t format;
+
+    /// @brief Palette of a CI4 or CI8 raw image buffer as RGBA16 or NULL for other formats
+    uint16_t* palette;
+
+    /// @brief Number of colors in the palette
+    int paletteSize;
+
     /// @brief Whether to toggle displaying debug text upon pressing the Start button on the N64 controller
     bool renderDebugFont;
+
+    /// @brief How the image is scaled onto the screen
+    qoi_zoom_mode zoomMode;
 } qoi_img_info_t;
 
+/// @brief Metadata read from the header of a QOI file without decoding it
+typedef struct qoi_probe_info {
+    /// @brief Width of the QOI image as stored in the file
+    int width;
+
+    /// @brief Height of the QOI image as stored in the file
+    int height;
+
+    /// @brief Number of channels of the QOI image where 3 is RGB and 4 is RGBA
+    int channels;
+
+    /// @brief Colorspace of the QOI image where 0 is sRGB and 1 is linear
+    int colorspace;
+
+    /// @brief Size of the QOI file in bytes
+    int fileSize;
+
+    /// @brief Power of two the QOI image will be downscaled by while decoding
+    int downscaleShift;
+
+    /// @brief Number of frames of a QOI animation or 0 for a still image
+    int frameCount;
+
+    /// @brief QOI_OK if the QOI image can be decoded and shown
+    qoi_error_code error;
+} qoi_probe_info_t;
+
+/*
+    A QOI animation is a header followed by frames
+
+    qoi_anim_header {
+        char magic[4]; // magic bytes "qoia"
+        uint32_t width; // width of the canvas in pixels (BE)
+        uint32_t height; // height of the canvas in pixels (BE)
+        uint32_t frames; // number of frames (BE)
+    };
+
+    qoi_anim_frame {
+        uint16_t x, y; // where the frame goes on the canvas (BE)
+        uint16_t width, height; // size of the area of the canvas the frame changes (BE)
+        uint16_t delay; // milliseconds the frame stays on screen (BE)
+        uint16_t reserved; // 0
+        uint32_t size; // size of the image that follows (BE)
+        uint8_t image[size]; // QOI, QOI-plus or QOI-LZ file of width x height pixels
+    };
+
+    The canvas keeps everything outside the area a frame changes from the frames before it
+*/
+
+/// @brief Size of the header of a QOI animation in bytes
+#define QOI_ANIM_HEADER_SIZE 16
+
+/// @brief Size of the record in front of every frame of a QOI animation in bytes
+#define QOI_ANIM_FRAME_HEADER_SIZE 16
+
+/// @brief A QOI animation being played
+typedef struct qoi_anim {
+    /// @brief QOI animation file. NULL once the animation is closed
+    FILE* fp;
+
+    /// @brief Name of the QOI animation file
+    char name[256];
+
+    /// @brief Width of the canvas in pixels
+    int width;
+
+    /// @brief Height of the canvas in pixels
+    int height;
+
+    /// @brief Number of frames in the animation
+    int frameCount;
+
+    /// @brief Frame beginQOIFrame() decodes next
+    int frame;
+
+    /// @brief Offset in the file of the record of the next frame
+    long nextFrame;
+
+    /// @brief Left edge of the area changed by the frame decoded last
+    int dirtyX;
+
+    /// @brief Top edge of the area changed by the frame decoded last
+    int dirtyY;
+
+    /// @brief Width of the area changed by the frame decoded last
+    int dirtyWidth;
+
+    /// @brief Height of the area changed by the frame decoded last
+    int dirtyHeight;
+
+    /// @brief Milliseconds the frame decoded last stays on screen
+    int delayMs;
+} qoi_anim_t;
+
 /// @brief This function draws image decoded from QOI
 /// @param disp Surface image
 /// @param info QOI info for drawing image properly
 void draw_image(surface_t* disp, qoi_img_info_t info);
 
+/// @brief This function draws a transition between two decoded images
+/// @param disp Surface image
+/// @param from QOI info of the image being transitioned from
+/// @param to QOI info of the image being transitioned to
+/// @param transition How to transition between the two images
+/// @param progress How far along the transition is from 0.0 to 1.0
+void draw_transition(surface_t* disp, qoi_img_info_t* from, qoi_img_info_t* to, qoi_transition_t transition, float progress);
+
+/// @brief Draws a page of thumbnails in a grid with the name of the selected image under it
+/// @param disp Surface image
+/// @param thumbnails Thumbnail of each cell from left to right and top to bottom or NULL if it is not made yet
+/// @param count Number of cells on the page, at most BROWSER_COLUMNS * BROWSER_ROWS
+/// @param selected Cell of the selected image
+/// @param name Name of the selected image
+void draw_browser(surface_t* disp, const qoi_img_info_t* const* thumbnails, int count, int selected, const char* name);
+
+/// @brief Gets the size of the raw image buffer an image is decoded into
+/// @details Covers the pixels in the output format and the palette after the indices when the image is shown as CI4 or CI8
+/// @param width Width of the image as shown in pixels
+/// @param height Height of the image as shown in pixels
+/// @return Size in bytes
+size_t getQOIBufferSize(int width, int height);
+
+/// @brief Starts decoding a QOI file into a raw image buffer
+/// @param filename Name of the QOI file
+/// @param bytes Pointer to a raw image buffer
+/// @param info QOI decoding info as a result of decoding qoi file
+/// @return true if decoding started, false if info contains the error
+bool beginQOIDecode(const char* filename, uint8_t* bytes, qoi_img_info_t* info);
+
+/// @brief Starts decoding only a rectangle of a QOI file at full resolution. Continue with stepQOIDecode()
+/// @details Pixels outside the rectangle are never written and decoding ends right after its last row
+/// so the rest of the file is not read. A rectangle reaching past an edge is moved back inside the image
+/// @param filename Name of the QOI file
+/// @param bytes Pointer to a raw image buffer
+/// @param info QOI decoding info as a result of decoding qoi file
+/// @param x Left edge of the rectangle in pixels of the QOI image
+/// @param y Top edge of the rectangle in pixels of the QOI image
+/// @param width Width of the rectangle, at most SCREEN_WIDTH
+/// @param height Height of the rectangle, at most SCREEN_HEIGHT
+/// @return true if decoding started, false if info contains the error
+bool beginQOIRegion(const char* filename, uint8_t* bytes, qoi_img_info_t* info, int x, int y, int width, int height);
+
+/// @brief Continues decoding the QOI file started by beginQOIDecode()
+/// @param budget Ticks to spend before returning. 0 or less decodes the whole image
+/// @return true once no QOI file is left to decode
+bool stepQOIDecode(long long budget);
+
+/// @brief Stops decoding the QOI file started by beginQOIDecode() if any
+void cancelQOIDecode();
+
 /// @brief This function decodes QOI file from from into the framebuffer
 /// @param filename Name of the QOI file
 /// @param bytes Pointer to a raw image buffer
 /// @param info QOI decoding info as a result of decoding qoi file
 void openQOIFile(const char* filename, uint8_t* bytes, qoi_img_info_t* info);
 
+/// @brief Opens a QOI animation to play with beginQOIFrame()
+/// @param filename Name of the QOI animation file
+/// @param anim QOI animation to set up
+/// @return QOI_OK if the animation can be played
+qoi_error_code openQOIAnimation(const char* filename, qoi_anim_t* anim);
+
+/// @brief Starts decoding the next frame of a QOI animation. Continue with stepQOIDecode()
+/// @param anim QOI animation opened with openQOIAnimation()
+/// @param shown Raw image buffer holding the frame on screen or NULL for the first frame
+/// @param bytes Raw image buffer to decode the frame into. The area changed by the frame on screen is copied over first
+/// @param info QOI decoding info as a result of decoding the frame
+/// @return true if decoding started, false if info contains the error
+bool beginQOIFrame(qoi_anim_t* anim, const uint8_t* shown, uint8_t* bytes, qoi_img_info_t* info);
+
+/// @brief Stops a QOI animation and closes its file
+/// @param anim QOI animation opened with openQOIAnimation()
+void closeQOIAnimation(qoi_anim_t* anim);
+
+/// @brief Starts shrinking a QOI file into a thumbnail. Continue with stepQOIDecode()
+/// @param filename Name of the QOI file or QOI animation
+/// @param bytes Memory for the thumbnail of QOI_THUMBNAIL_SIZE bytes
+/// @param info QOI decoding info as a result of making the thumbnail
+/// @return true if decoding started, false if info contains the error
+bool beginQOIThumbnail(const char* filename, uint8_t* bytes, qoi_img_info_t* info);
+
+/// @brief Reads only the header of a QOI file to find out what decoding it involves
+/// @param filename Name of the QOI file
+/// @param probe Metadata read from the header of the QOI file
+void qoi_probe(const char* filename, qoi_probe_info_t* probe);
+
+/// @brief Switches to the next zoom mode
+/// @param info QOI decoding info
+inline void cycleZoomMode(qoi_img_info_t* info) {
+    info->zoomMode = (info->zoomMode + 1) % QOI_ZOOM_MODES;
+}
+
 /// @brief Toggles printing debugging text
 /// @param info QOI decoding info
 inline void toggleDebugText(qoi_img_info_t* info) {
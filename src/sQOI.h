@@ -40,6 +40,13 @@
         // 1 = all channels linear
     };
 
+    A QOI-plus file is a QOI file with a row filter applied before encoding.
+    It has the magic bytes "qoip" followed by the same header fields, then one
+    filter byte for each row (see enum qoi_row_filter), then the data chunks
+    and the 8-byte end marker. The chunks encode the filtered pixels so the
+    same decoder is used. qoi_unfilter_row() turns each decoded row back into
+    the image. Filters only apply to the color channels, alpha is stored as is
+
 */
 
 /*
@@ -91,6 +98,47 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
+
+/*
+    Host specific fast paths for qoi_decode_span()
+    Define QOI_NO_SIMD before including this library to use the portable code only
+
+    Define QOI_SIMD_DELTA_BATCH to also add up runs of four QOI_OP_DIFF or QOI_OP_LUMA chunks
+    with a vectorised prefix sum. It is off by default because the scan ahead and the scalar
+    running array writes it still needs cost more than they save on photographic images
+*/
+
+#if !defined(QOI_NO_SIMD) && defined(__SSE2__)
+#define QOI_SIMD_SSE2
+#include <emmintrin.h>
+#elif !defined(QOI_NO_SIMD) && defined(__ARM_NEON)
+#define QOI_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+    Define QOI_PROFILE_CLOCK() before including this library to count the chunks the decoders read
+    and the clock ticks each kind of chunk takes into qoi_profile. It must read a free running
+    32-bit counter such as the COP0 Count register. The totals only grow so clear qoi_profile
+    before the image to measure. Each chunk reads the counter twice more, so expect the decoder
+    to run slower while profiling
+*/
+
+#ifdef QOI_PROFILE_CLOCK
+#define QOI_PROFILE_START(clock) uint32_t clock = QOI_PROFILE_CLOCK()
+#define QOI_PROFILE_STOP(clock, op) \
+    do \
+    { \
+        uint32_t qoi_profile_now = QOI_PROFILE_CLOCK(); \
+        qoi_profile.ticks[op] += qoi_profile_now - (clock); \
+        qoi_profile.chunks[op]++; \
+        (clock) = qoi_profile_now; \
+    } while (0)
+#else
+#define QOI_PROFILE_START(clock)
+#define QOI_PROFILE_STOP(clock, op)
+#endif
 
 /* QOI OPCODES */
 
@@ -109,12 +157,108 @@ enum qoi_pixel_color {QOI_RED, QOI_GREEN, QOI_BLUE, QOI_ALPHA};
 enum qoi_channels {QOI_WHITESPACE = 3, QOI_TRANSPARENT = 4};
 enum qoi_colorspace {QOI_SRGB, QOI_LINEAR};
 
+/* Row filters of a QOI-plus file */
+enum qoi_row_filter {
+    QOI_FILTER_NONE, /* pixels are stored as is */
+    QOI_FILTER_UP, /* pixels are stored as the difference from the pixel above */
+    QOI_FILTERS
+};
+
+/* How hard the encoder works on each pixel. Every effort level writes a valid QOI stream */
+enum qoi_effort {
+    QOI_EFFORT_DEFAULT, /* checks the running array, then differences, then writes the color */
+    QOI_EFFORT_FAST /* compares pixels as words and only reads the running array when a difference does not fit */
+};
+
+/* Pixel formats the specialised span decoders write */
+enum qoi_output_format {
+    QOI_OUTPUT_RGBA32, /* 8 bits per channel in red, green, blue, alpha byte order */
+    QOI_OUTPUT_RGBA16, /* native 16 bit value with 5 bits per color and 1 bit of alpha (RGBA 5551) */
+    QOI_OUTPUT_I8, /* 8 bit grayscale intensity */
+    QOI_OUTPUT_IA8, /* 4 bit grayscale intensity in the high bits and 4 bit alpha in the low bits */
+    QOI_OUTPUT_RGBA32_PREMULTIPLIED, /* QOI_OUTPUT_RGBA32 with the colors multiplied by alpha */
+    QOI_OUTPUT_RGBA16_PREMULTIPLIED, /* QOI_OUTPUT_RGBA16 with the colors multiplied by alpha before they are cut to 5 bits */
+    QOI_OUTPUT_FORMATS
+};
+
+/* Work the decoders count in qoi_profile when QOI_PROFILE_CLOCK() is defined */
+enum qoi_profile_op {
+    QOI_PROFILE_RGB, /* QOI_OP_RGB chunks */
+    QOI_PROFILE_RGBA, /* QOI_OP_RGBA chunks */
+    QOI_PROFILE_INDEX, /* QOI_OP_INDEX chunks */
+    QOI_PROFILE_DIFF, /* QOI_OP_DIFF chunks */
+    QOI_PROFILE_LUMA, /* QOI_OP_LUMA chunks */
+    QOI_PROFILE_RUN, /* QOI_OP_RUN chunks, not counting the pixels they fill */
+    QOI_PROFILE_HASH, /* writes to the running array after every chunk */
+    QOI_PROFILE_FILL, /* runs written out by the span decoders */
+    QOI_PROFILE_STORE, /* single pixels converted and written out by the span decoders */
+    QOI_PROFILE_OPS
+};
+
+/* Bytes per pixel of each output format */
+static const uint8_t QOI_OUTPUT_BYTES[QOI_OUTPUT_FORMATS] = {4, 2, 1, 1, 4, 2};
+
+/* Whether each output format multiplies the colors by alpha */
+static const bool QOI_OUTPUT_PREMULTIPLIED[QOI_OUTPUT_FORMATS] = {false, false, false, false, true, true};
+
+/* Forces a function to be inlined so constant arguments specialise it */
+#if defined(__GNUC__) || defined(__clang__)
+#define QOI_FORCE_INLINE static inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define QOI_FORCE_INLINE static __forceinline
+#else
+#define QOI_FORCE_INLINE static inline
+#endif
+
 /* QOI magic number */
 static const uint8_t QOI_MAGIC[4] = {'q', 'o', 'i', 'f'};
 
+/* QOI-plus magic number */
+static const uint8_t QOI_PLUS_MAGIC[4] = {'q', 'o', 'i', 'p'};
+
 /* QOI end of file */
 static const uint8_t QOI_PADDING[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
 
+/* sRGB color channel to linear light, rounded to 8 bits. Dark colors lose precision */
+static const uint8_t QOI_SRGB_TO_LINEAR[256] = {
+      0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,   3,   3,
+      4,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,   6,   7,   7,   7,
+      8,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  12,  12,  12,  13,
+     13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  17,  18,  18,  19,  19,  20,
+     20,  21,  22,  22,  23,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+     30,  30,  31,  32,  32,  33,  34,  35,  35,  36,  37,  37,  38,  39,  40,  41,
+     41,  42,  43,  44,  45,  45,  46,  47,  48,  49,  50,  51,  51,  52,  53,  54,
+     55,  56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,
+     71,  72,  73,  74,  76,  77,  78,  79,  80,  81,  82,  84,  85,  86,  87,  88,
+     90,  91,  92,  93,  95,  96,  97,  99, 100, 101, 103, 104, 105, 107, 108, 109,
+    111, 112, 114, 115, 116, 118, 119, 121, 122, 124, 125, 127, 128, 130, 131, 133,
+    134, 136, 138, 139, 141, 142, 144, 146, 147, 149, 151, 152, 154, 156, 157, 159,
+    161, 163, 164, 166, 168, 170, 171, 173, 175, 177, 179, 181, 183, 184, 186, 188,
+    190, 192, 194, 196, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218, 220,
+    222, 224, 226, 229, 231, 233, 235, 237, 239, 242, 244, 246, 248, 250, 253, 255
+};
+
+/* Linear light color channel to sRGB, rounded to 8 bits */
+static const uint8_t QOI_LINEAR_TO_SRGB[256] = {
+      0,  13,  22,  28,  34,  38,  42,  46,  50,  53,  56,  59,  61,  64,  66,  69,
+     71,  73,  75,  77,  79,  81,  83,  85,  86,  88,  90,  92,  93,  95,  96,  98,
+     99, 101, 102, 104, 105, 106, 108, 109, 110, 112, 113, 114, 115, 117, 118, 119,
+    120, 121, 122, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135, 136,
+    137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 148, 149, 150, 151,
+    152, 153, 154, 155, 155, 156, 157, 158, 159, 159, 160, 161, 162, 163, 163, 164,
+    165, 166, 167, 167, 168, 169, 170, 170, 171, 172, 173, 173, 174, 175, 175, 176,
+    177, 178, 178, 179, 180, 180, 181, 182, 182, 183, 184, 185, 185, 186, 187, 187,
+    188, 189, 189, 190, 190, 191, 192, 192, 193, 194, 194, 195, 196, 196, 197, 197,
+    198, 199, 199, 200, 200, 201, 202, 202, 203, 203, 204, 205, 205, 206, 206, 207,
+    208, 208, 209, 209, 210, 210, 211, 212, 212, 213, 213, 214, 214, 215, 215, 216,
+    216, 217, 218, 218, 219, 219, 220, 220, 221, 221, 222, 222, 223, 223, 224, 224,
+    225, 226, 226, 227, 227, 228, 228, 229, 229, 230, 230, 231, 231, 232, 232, 233,
+    233, 234, 234, 235, 235, 236, 236, 237, 237, 238, 238, 238, 239, 239, 240, 240,
+    241, 241, 242, 242, 243, 243, 244, 244, 245, 245, 246, 246, 246, 247, 247, 248,
+    248, 249, 249, 250, 250, 251, 251, 251, 252, 252, 253, 253, 254, 254, 255, 255
+};
+
 /* QOI descriptor as read by the header */
 typedef struct
 {
@@ -155,7 +299,8 @@ typedef struct
     uint8_t* offset;
 
     uint8_t run : 8;
-    uint32_t pad : 24;
+    uint8_t effort : 8;
+    uint32_t pad : 16;
 
 } qoi_enc_t;
 
@@ -176,10 +321,36 @@ typedef struct
     uint8_t* data;
     uint8_t* offset;
 
+    /* Table the transfer span decoders look every color channel up in, such as QOI_SRGB_TO_LINEAR */
+    const uint8_t* transfer;
+
     uint8_t run : 8;
     uint32_t pad : 24;
 } qoi_dec_t;
 
+/* Decodes up to max_pixels pixels into out in one output format and returns how many were written */
+typedef size_t (*qoi_span_decoder_t)(qoi_dec_t* dec, void* out, size_t max_pixels);
+
+/* Rectangle of an image in pixels */
+typedef struct
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} qoi_region_t;
+
+/* Totals counted by the decoders when QOI_PROFILE_CLOCK() is defined. The 32-bit ticks keep the count cheap on 32-bit machines */
+typedef struct
+{
+    uint32_t chunks[QOI_PROFILE_OPS];
+    uint32_t ticks[QOI_PROFILE_OPS];
+} qoi_profile_t;
+
+#ifdef QOI_PROFILE_CLOCK
+qoi_profile_t qoi_profile;
+#endif
+
 /* Machine specific code */
 
 static inline uint32_t qoi_get_be32(uint32_t value);
@@ -205,10 +376,21 @@ void qoi_set_colorspace(qoi_desc_t* desc, uint8_t colorspace);
 void write_qoi_header(qoi_desc_t *desc, void* dest);
 bool read_qoi_header(qoi_desc_t *desc, void* data);
 
+/* QOI-plus container functions */
+
+void write_qoi_plus_header(qoi_desc_t *desc, void* dest);
+bool read_qoi_plus_header(qoi_desc_t *desc, void* data);
+static inline size_t qoi_plus_header_size(qoi_desc_t *desc);
+
+void qoi_filter_row(uint32_t* out, const uint32_t* row, const uint32_t* above, size_t count, uint8_t filter);
+void qoi_unfilter_row(uint32_t* row, const uint32_t* above, size_t count, uint8_t filter);
+static inline uint32_t qoi_color_mask(void);
+
 /* QOI encoder functions */
 
 bool qoi_enc_init(qoi_desc_t* desc, qoi_enc_t* enc, void* data);
 bool qoi_enc_done(qoi_enc_t* enc);
+void qoi_enc_set_effort(qoi_enc_t* enc, uint8_t effort);
 
 void qoi_encode_chunk(qoi_desc_t *desc, qoi_enc_t *enc, void *qoi_pixel_bytes);
 
@@ -220,12 +402,33 @@ static inline void qoi_enc_diff(qoi_enc_t *enc, uint8_t red_diff, uint8_t green_
 static inline void qoi_enc_luma(qoi_enc_t *enc, uint8_t green_diff, uint8_t dr_dg, uint8_t db_dg);
 static inline void qoi_enc_run(qoi_enc_t *enc);
 
+static inline bool qoi_enc_add_run(qoi_enc_t *enc);
+static inline void qoi_encode_pixel_default(qoi_desc_t *desc, qoi_enc_t *enc, qoi_pixel_t cur_pixel);
+static inline void qoi_encode_pixel_fast(qoi_enc_t *enc, qoi_pixel_t cur_pixel);
+
 /* QOI decoder functions */
 
 bool qoi_dec_init(qoi_desc_t* desc, qoi_dec_t* dec, void* data, size_t len);
 bool qoi_dec_done(qoi_dec_t* dec);
 
 qoi_pixel_t qoi_decode_chunk(qoi_dec_t* dec);
+size_t qoi_decode_span(qoi_dec_t* dec, uint32_t* out, size_t max_pixels);
+size_t qoi_skip_pixels(qoi_dec_t* dec, size_t max_pixels);
+size_t qoi_decode_region(qoi_desc_t* desc, qoi_dec_t* dec, const qoi_region_t* region, void* out, size_t stride, uint8_t output_format);
+
+qoi_span_decoder_t qoi_select_span_decoder(uint8_t channels, uint8_t output_format);
+qoi_span_decoder_t qoi_select_transfer_span_decoder(uint8_t channels, uint8_t output_format);
+void qoi_convert_pixels(const qoi_pixel_t* pixels, void* out, size_t count, uint8_t output_format);
+void qoi_convert_pixels_transfer(const qoi_pixel_t* pixels, void* out, size_t count, uint8_t output_format, const uint8_t* transfer);
+static inline qoi_pixel_t qoi_transfer_pixel(qoi_pixel_t px, const uint8_t* transfer);
+
+static inline qoi_pixel_t qoi_premultiply(qoi_pixel_t px);
+static inline void qoi_decode_op(qoi_dec_t* dec);
+QOI_FORCE_INLINE void qoi_decode_op_channels(qoi_dec_t* dec, const uint8_t channels);
+static inline void qoi_fill_run(uint32_t* out, uint32_t value, size_t count);
+static inline void qoi_fill_run16(uint16_t* out, uint16_t value, size_t count);
+static inline int qoi_delta_ops_ahead(const uint8_t* offset);
+static inline uint32_t qoi_delta_word(qoi_dec_t* dec, uint8_t tag);
 
 static inline void qoi_dec_rgb(qoi_dec_t* dec);
 static inline void qoi_dec_rgba(qoi_dec_t* dec);
@@ -389,6 +592,102 @@ bool read_qoi_header(qoi_desc_t *desc, void* data)
     return true;
 }
 
+/* Writes the QOI-plus metadata information to the file. The row filters follow and are written by the caller */
+void write_qoi_plus_header(qoi_desc_t *desc, void* dest)
+{
+    if (dest == NULL || desc == NULL) return;
+
+    uint8_t *byte = (uint8_t*)dest;
+
+    /* The fields after the magic characters are the same as a QOI header */
+    write_qoi_header(desc, dest);
+
+    byte[0] = QOI_PLUS_MAGIC[0];
+    byte[1] = QOI_PLUS_MAGIC[1];
+    byte[2] = QOI_PLUS_MAGIC[2];
+    byte[3] = QOI_PLUS_MAGIC[3];
+}
+
+/* Check for vaild QOI-plus file */
+bool read_qoi_plus_header(qoi_desc_t *desc, void* data)
+{
+    if (data == NULL || desc == NULL) return false;
+
+    uint8_t *byte = (uint8_t*)data;
+    uint8_t header[14];
+
+    if (!(byte[0] == QOI_PLUS_MAGIC[0] &&
+        byte[1] == QOI_PLUS_MAGIC[1] &&
+        byte[2] == QOI_PLUS_MAGIC[2] &&
+        byte[3] == QOI_PLUS_MAGIC[3])
+    ) return false;
+
+    /* Read the rest of the header as a QOI header */
+    memcpy(header, byte, 14);
+    memcpy(header, QOI_MAGIC, 4);
+
+    return read_qoi_header(desc, header);
+}
+
+/* Size of the QOI-plus header including the row filters. The data chunks start here */
+static inline size_t qoi_plus_header_size(qoi_desc_t *desc)
+{
+    return 14 + (size_t)desc->height;
+}
+
+/* Mask of the color channels of a pixel so filters leave alpha alone */
+static inline uint32_t qoi_color_mask(void)
+{
+    qoi_pixel_t mask;
+
+    qoi_set_pixel_rgba(&mask, 0xFF, 0xFF, 0xFF, 0x00);
+    return mask.concatenated_pixel_values;
+}
+
+/* 
+    Filters a row of pixels for encoding into a QOI-plus file. above is the unfiltered row above
+    or NULL for the first row. The channels are subtracted bytewise inside a word so they wrap around like the decoder
+*/
+void qoi_filter_row(uint32_t* out, const uint32_t* row, const uint32_t* above, size_t count, uint8_t filter)
+{
+    const uint32_t color_mask = qoi_color_mask();
+    size_t i;
+
+    if (filter != QOI_FILTER_UP || above == NULL)
+    {
+        memcpy(out, row, count * sizeof(uint32_t));
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t a = row[i];
+        uint32_t b = above[i] & color_mask;
+
+        out[i] = ((a | 0x80808080) - (b & 0x7F7F7F7F)) ^ ((a ^ ~b) & 0x80808080);
+    }
+}
+
+/* 
+    Undoes the filter of a decoded row of a QOI-plus file in place. above is the unfiltered row above
+    or NULL for the first row. The channels are added bytewise inside a word so no carry reaches the next channel
+*/
+void qoi_unfilter_row(uint32_t* row, const uint32_t* above, size_t count, uint8_t filter)
+{
+    const uint32_t color_mask = qoi_color_mask();
+    size_t i;
+
+    if (filter != QOI_FILTER_UP || above == NULL) return;
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t a = row[i];
+        uint32_t b = above[i] & color_mask;
+
+        row[i] = ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+    }
+}
+
 /* Initalize the QOI encoder to the default state */
 bool qoi_enc_init(qoi_desc_t* desc, qoi_enc_t* enc, void* data)
 {
@@ -401,6 +700,7 @@ bool qoi_enc_init(qoi_desc_t* desc, qoi_enc_t* enc, void* data)
 
     enc->pad = 0;
     enc->run = 0;
+    enc->effort = QOI_EFFORT_DEFAULT;
     enc->pixel_offset = 0;
 
     /*  
@@ -422,6 +722,14 @@ bool qoi_enc_done(qoi_enc_t* enc)
     return (enc->pixel_offset >= enc->len); /* Has the encoder encoded all the pixels yet? */
 }
 
+/* Sets how hard the encoder works on each pixel. See enum qoi_effort */
+void qoi_enc_set_effort(qoi_enc_t* enc, uint8_t effort)
+{
+    if (enc == NULL) return;
+
+    enc->effort = effort;
+}
+
 /* Initalize the decoder to the default state */
 bool qoi_dec_init(qoi_desc_t* desc, qoi_dec_t* dec, void* data, size_t len)
 {
@@ -445,6 +753,7 @@ bool qoi_dec_init(qoi_desc_t* desc, qoi_dec_t* dec, void* data, size_t len)
 
     dec->data = (uint8_t*)data;
     dec->offset = dec->data + 14;
+    dec->transfer = NULL;
 
     return true;
 }
@@ -542,40 +851,32 @@ static inline void qoi_enc_run(qoi_enc_t *enc)
 }
 
 /* 
-    WARNING: In this function below, you must provide enough memory to put the encoded images 
-    The safest amount of space to store encoded images is the equation below
-
-    (image width) * (image height) * ((amount of channels in a pixel) + 1) = bytes required to store encoded image
+    Adds the current pixel to the run and writes the run once it is as long as it can be
+    or the image ends. Returns true if the run was written
 */
-
-void qoi_encode_chunk(qoi_desc_t *desc, qoi_enc_t *enc, void *qoi_pixel_bytes)
+static inline bool qoi_enc_add_run(qoi_enc_t *enc)
 {
+    /*  Note that the runlengths 63 and 64 (b111110 and b111111) are illegal as they are
+        occupied by the QOI_OP_RGB and QOI_OP_RGBA tags.
+        pixel_offset is only advanced after this pixel so the last pixel is at len - 1 */
+    if (++enc->run >= 62 || enc->pixel_offset + 1 >= enc->len)
+    {
+        qoi_enc_run(enc);
+        return true;
+    }
 
-    /* 
-        Assume that the pixel byte order is the following below
-        bytes[0] = red;
-        bytes[1] = green;
-        bytes[2] = blue;
-        bytes[3] = alpha;
-    */
-
-    qoi_pixel_t cur_pixel = *((qoi_pixel_t*)qoi_pixel_bytes);
-
-    /* Assume an RGB pixel with three channels has an alpha value that makes pixels opaque */
-    if (desc->channels < 4) 
-        cur_pixel.alpha = 255;
+    return false;
+}
 
+/* Encodes a pixel by checking the running array, then differences, then writing the color */
+static inline void qoi_encode_pixel_default(qoi_desc_t *desc, qoi_enc_t *enc, qoi_pixel_t cur_pixel)
+{
     uint8_t index_pos = qoi_get_index_position(cur_pixel);
 
     /* Increment run length by 1 if pixels are the same */
     if (qoi_cmp_pixel(cur_pixel, enc->prev_pixel, desc->channels))
     {
-        /*  Note that the runlengths 63 and 64 (b111110 and b111111) are illegal as they are
-            occupied by the QOI_OP_RGB and QOI_OP_RGBA tags. */
-        if (++enc->run >= 62 || enc->pixel_offset >= enc->len)
-        {
-            qoi_enc_run(enc);
-        }
+        qoi_enc_add_run(enc);
     }
     else
     {
@@ -640,6 +941,99 @@ void qoi_encode_chunk(qoi_desc_t *desc, qoi_enc_t *enc, void *qoi_pixel_bytes)
 
         }
     }
+}
+
+/*
+    Encodes a pixel for throughput. RGB pixels always have an alpha of 255 by now so runs are found with one word compare.
+    QOI_OP_DIFF is tried before the running array because it is worked out in registers and is just as short,
+    so the running array is only read when the difference does not fit. The output is the same size as the default effort
+*/
+static inline void qoi_encode_pixel_fast(qoi_enc_t *enc, qoi_pixel_t cur_pixel)
+{
+    if (cur_pixel.concatenated_pixel_values == enc->prev_pixel.concatenated_pixel_values)
+    {
+        qoi_enc_add_run(enc);
+        return;
+    }
+
+    if (enc->run > 0)
+        qoi_enc_run(enc);
+
+    uint8_t index_pos = qoi_get_index_position(cur_pixel);
+
+    if (cur_pixel.alpha == enc->prev_pixel.alpha)
+    {
+        int8_t red_diff = cur_pixel.red - enc->prev_pixel.red;
+        int8_t green_diff = cur_pixel.green - enc->prev_pixel.green;
+        int8_t blue_diff = cur_pixel.blue - enc->prev_pixel.blue;
+
+        /* Adding two biases the differences so one unsigned compare checks -2 to 1 */
+        if ((uint8_t)(red_diff + 2) < 4 && (uint8_t)(green_diff + 2) < 4 && (uint8_t)(blue_diff + 2) < 4)
+        {
+            qoi_enc_diff(enc, red_diff, green_diff, blue_diff);
+        }
+        else if (enc->buffer[index_pos].concatenated_pixel_values == cur_pixel.concatenated_pixel_values)
+        {
+            qoi_enc_index(enc, index_pos);
+            return;
+        }
+        else
+        {
+            int8_t dr_dg = red_diff - green_diff;
+            int8_t db_dg = blue_diff - green_diff;
+
+            if ((uint8_t)(green_diff + 32) < 64 && (uint8_t)(dr_dg + 8) < 16 && (uint8_t)(db_dg + 8) < 16)
+                qoi_enc_luma(enc, green_diff, dr_dg, db_dg);
+            else
+                qoi_enc_rgb(enc, cur_pixel);
+        }
+    }
+    else if (enc->buffer[index_pos].concatenated_pixel_values == cur_pixel.concatenated_pixel_values)
+    {
+        qoi_enc_index(enc, index_pos);
+        return;
+    }
+    else
+    {
+        qoi_enc_rgba(enc, cur_pixel);
+    }
+
+    enc->buffer[index_pos] = cur_pixel;
+}
+
+/* 
+    WARNING: In this function below, you must provide enough memory to put the encoded images 
+    The safest amount of space to store encoded images is the equation below
+
+    (image width) * (image height) * ((amount of channels in a pixel) + 1) = bytes required to store encoded image
+*/
+
+void qoi_encode_chunk(qoi_desc_t *desc, qoi_enc_t *enc, void *qoi_pixel_bytes)
+{
+
+    /* 
+        Assume that the pixel byte order is the following below
+        bytes[0] = red;
+        bytes[1] = green;
+        bytes[2] = blue;
+        bytes[3] = alpha;
+    */
+
+    qoi_pixel_t cur_pixel = *((qoi_pixel_t*)qoi_pixel_bytes);
+
+    /* Assume an RGB pixel with three channels has an alpha value that makes pixels opaque */
+    if (desc->channels < 4) 
+        cur_pixel.alpha = 255;
+
+    switch (enc->effort)
+    {
+        case QOI_EFFORT_FAST:
+            qoi_encode_pixel_fast(enc, cur_pixel);
+            break;
+        default:
+            qoi_encode_pixel_default(desc, enc, cur_pixel);
+            break;
+    }
 
     /* Advance the pixel offset by one and sets the previous pixel to the current pixel */
     enc->prev_pixel = cur_pixel;
@@ -745,66 +1139,614 @@ qoi_pixel_t qoi_decode_chunk(qoi_dec_t* dec)
         dec->run--;
 
     else
-    {
-        uint8_t tag = dec->offset[0]; /* opcode for qoi decompression */
+        qoi_decode_op(dec);
+    
+    dec->pixel_seek++;
+    return dec->prev_pixel;
+}
 
-        /*  
-            The 8-bit tags have precedence over the 2-bit tags. 
-            A decoder must check for the presence of an 8-bit tag first. 
-        */
+/* Decodes the chunk at the current offset into the previous pixel and the running array */
+static inline void qoi_decode_op(qoi_dec_t* dec)
+{
+    qoi_decode_op_channels(dec, QOI_TRANSPARENT);
+}
+
+/*
+    Decodes the chunk at the current offset for an image with a known amount of channels.
+    Always inlined so each caller passing a constant gets its own copy with the channel checks folded away.
+    Alpha of an RGB image stays at 255 because a valid RGB stream never changes it with QOI_OP_RGBA
+*/
+QOI_FORCE_INLINE void qoi_decode_op_channels(qoi_dec_t* dec, const uint8_t channels)
+{
+    uint8_t tag = dec->offset[0]; /* opcode for qoi decompression */
+    QOI_PROFILE_START(clock);
+
+    /*  
+        The 8-bit tags have precedence over the 2-bit tags. 
+        A decoder must check for the presence of an 8-bit tag first. 
+    */
 
-        if (tag == QOI_OP_RGB) /* RGB pixel */
+    if (tag == QOI_OP_RGB) /* RGB pixel */
+    {
+        qoi_dec_rgb(dec);
+        QOI_PROFILE_STOP(clock, QOI_PROFILE_RGB);
+    }
+    else if (tag == QOI_OP_RGBA) /* RGBA pixel */
+    {
+        if (channels < 4)
         {
             qoi_dec_rgb(dec);
+            dec->offset += 1; /* skip the alpha value */
         }
-        else if (tag == QOI_OP_RGBA) /* RGBA pixel */
+        else
         {
             qoi_dec_rgba(dec);
         }
-        else
+
+        QOI_PROFILE_STOP(clock, QOI_PROFILE_RGBA);
+    }
+    else
+    {
+        uint8_t tag_type = (tag & QOI_TAG); /* opcode for qoi decompression */
+
+        switch(tag_type)
         {
-            uint8_t tag_type = (tag & QOI_TAG); /* opcode for qoi decompression */
+            case QOI_OP_INDEX:
+            {
+                qoi_dec_index(dec, tag);
+                QOI_PROFILE_STOP(clock, QOI_PROFILE_INDEX);
 
-            switch(tag_type)
+                break;
+            }
+            case QOI_OP_DIFF:
             {
-                case QOI_OP_INDEX:
-                {
-                    qoi_dec_index(dec, tag);
+                qoi_dec_diff(dec, tag);
+                QOI_PROFILE_STOP(clock, QOI_PROFILE_DIFF);
 
-                    break;
-                }
-                case QOI_OP_DIFF:
-                {
-                    qoi_dec_diff(dec, tag);
+                break;
+            }
+            case QOI_OP_LUMA:
+            {
+                qoi_dec_luma(dec, tag);
+                QOI_PROFILE_STOP(clock, QOI_PROFILE_LUMA);
 
-                    break;
-                }
-                case QOI_OP_LUMA:
-                {
-                    qoi_dec_luma(dec, tag);
+                break;
+            }
+            case QOI_OP_RUN:
+            {
+                qoi_dec_run(dec, tag);
+                QOI_PROFILE_STOP(clock, QOI_PROFILE_RUN);
 
-                    break;
-                }
-                case QOI_OP_RUN:
-                {
-                    qoi_dec_run(dec, tag);
+                break;
+            }
+            default:
+            {
+                dec->offset += 1; /* move on to the new packet if there is an invaild opcode */
 
-                    break;
-                }
-                default:
-                {
-                    dec->offset += 1; /* move on to the new packet if there is an invaild opcode */
+                break;
+            }
+        }           
+    }
 
-                    break;
-                }
-            }           
+    if (channels < 4) /* the alpha term of the hash is a constant for RGB images */
+        dec->buffer[(dec->prev_pixel.red * 3 + dec->prev_pixel.green * 5 + dec->prev_pixel.blue * 7 + 255 * 11) % 64] = dec->prev_pixel;
+    else
+        dec->buffer[qoi_get_index_position(dec->prev_pixel)] = dec->prev_pixel;
+
+    QOI_PROFILE_STOP(clock, QOI_PROFILE_HASH);
+}
+
+/* Writes the same pixel value a number of times */
+static inline void qoi_fill_run(uint32_t* out, uint32_t value, size_t count)
+{
+    size_t i = 0;
+
+#if defined(QOI_SIMD_SSE2)
+    __m128i values = _mm_set1_epi32((int32_t)value);
+
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i*)(out + i), values);
+#elif defined(QOI_SIMD_NEON)
+    uint32x4_t values = vdupq_n_u32(value);
+
+    for (; i + 4 <= count; i += 4)
+        vst1q_u32(out + i, values);
+#endif
+
+    for (; i < count; i++)
+        out[i] = value;
+}
+
+/* Counts how many of the next four chunks are QOI_OP_DIFF or QOI_OP_LUMA (0x40 to 0xBF) */
+static inline int qoi_delta_ops_ahead(const uint8_t* offset)
+{
+    int count;
+
+    for (count = 0; count < 4; count++)
+    {
+        uint8_t tag = offset[0];
+
+        if ((uint8_t)(tag - QOI_OP_DIFF) >= 0x80)
+            break;
+
+        offset += (tag & QOI_TAG) == QOI_OP_DIFF ? 1 : 2;
+    }
+
+    return count;
+}
+
+/* Writes the same 16 bit pixel value a number of times */
+static inline void qoi_fill_run16(uint16_t* out, uint16_t value, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+        out[i] = value;
+}
+
+/*
+    Gets the per channel differences of a QOI_OP_DIFF or QOI_OP_LUMA chunk as a pixel
+    where each channel wraps around the same way as adding to the previous pixel does
+*/
+static inline uint32_t qoi_delta_word(qoi_dec_t* dec, uint8_t tag)
+{
+    uint8_t red_diff, green_diff, blue_diff;
+
+    if ((tag & QOI_TAG) == QOI_OP_DIFF)
+    {
+        red_diff = ((tag >> 4) & 0x03) - 2;
+        green_diff = ((tag >> 2) & 0x03) - 2;
+        blue_diff = (tag & 0x03) - 2;
+
+        dec->offset += 1;
+    }
+    else
+    {
+        uint8_t lumaGreen = (tag & QOI_TAG_MASK) - 32;
+
+        red_diff = lumaGreen + ((dec->offset[1] & 0xF0) >> 4) - 8;
+        green_diff = lumaGreen;
+        blue_diff = lumaGreen + (dec->offset[1] & 0x0F) - 8;
+
+        dec->offset += 2;
+    }
+
+    /* Pack the differences in memory order so they line up with the pixel channels */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return ((uint32_t)red_diff << 24) | ((uint32_t)green_diff << 16) | ((uint32_t)blue_diff << 8);
+#else
+    return (uint32_t)red_diff | ((uint32_t)green_diff << 8) | ((uint32_t)blue_diff << 16);
+#endif
+}
+
+/* 
+    Decodes up to max_pixels pixels straight into out and returns how many were written
+    Runs are written as a block instead of one pixel at a time, with vector stores on hosts
+    with SSE2 or NEON, and see QOI_SIMD_DELTA_BATCH for QOI_OP_DIFF and QOI_OP_LUMA chunks
+
+    WARNING: out must have room for max_pixels pixels
+*/
+size_t qoi_decode_span(qoi_dec_t* dec, uint32_t* out, size_t max_pixels)
+{
+    size_t written = 0;
+
+    while (written < max_pixels)
+    {
+        if (dec->run > 0)
+        {
+            size_t count = max_pixels - written;
+
+            if (count > dec->run)
+                count = dec->run;
+            if (count > dec->img_area - dec->pixel_seek)
+                count = dec->img_area - dec->pixel_seek;
+            if (count == 0)
+                break;
+
+            qoi_fill_run(out + written, dec->prev_pixel.concatenated_pixel_values, count);
+
+            dec->run -= count;
+            dec->pixel_seek += count;
+            written += count;
+
+            continue;
+        }
+
+        if (qoi_dec_done(dec))
+            break;
+
+#if (defined(QOI_SIMD_SSE2) || defined(QOI_SIMD_NEON)) && defined(QOI_SIMD_DELTA_BATCH)
+        /*
+            Chunks 0x40 to 0xBF are QOI_OP_DIFF and QOI_OP_LUMA which only add to the previous pixel.
+            The chunks are at most eight bytes long so they never read past the end of the padding.
+        */
+        if (
+            max_pixels - written >= 4 &&
+            dec->img_area - dec->pixel_seek >= 4 &&
+            qoi_delta_ops_ahead(dec->offset) >= 4
+        )
+        {
+            uint32_t deltas[4];
+            int count;
+
+            for (count = 0; count < 4; count++)
+                deltas[count] = qoi_delta_word(dec, dec->offset[0]);
+
+            {
+                qoi_pixel_t pixels[4];
+                int lane;
+
+#if defined(QOI_SIMD_SSE2)
+                __m128i sums = _mm_loadu_si128((__m128i*)deltas);
+
+                /* Prefix sum across the four pixels, each byte wrapping on its own */
+                sums = _mm_add_epi8(sums, _mm_slli_si128(sums, 4));
+                sums = _mm_add_epi8(sums, _mm_slli_si128(sums, 8));
+                sums = _mm_add_epi8(sums, _mm_set1_epi32((int32_t)dec->prev_pixel.concatenated_pixel_values));
+
+                _mm_storeu_si128((__m128i*)(out + written), sums);
+
+                /* Move the pixels out through registers rather than reloading them from memory */
+                pixels[0].concatenated_pixel_values = (uint32_t)_mm_cvtsi128_si32(sums);
+                pixels[1].concatenated_pixel_values = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 4));
+                pixels[2].concatenated_pixel_values = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+                pixels[3].concatenated_pixel_values = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 12));
+#else
+                uint8x16_t sums = vreinterpretq_u8_u32(vld1q_u32(deltas));
+                uint8x16_t zero = vdupq_n_u8(0);
+
+                /* Prefix sum across the four pixels, each byte wrapping on its own */
+                sums = vaddq_u8(sums, vextq_u8(zero, sums, 12));
+                sums = vaddq_u8(sums, vextq_u8(zero, sums, 8));
+                sums = vaddq_u8(sums, vreinterpretq_u8_u32(vdupq_n_u32(dec->prev_pixel.concatenated_pixel_values)));
+
+                vst1q_u8((uint8_t*)(out + written), sums);
+
+                /* Move the pixels out through registers rather than reloading them from memory */
+                pixels[0].concatenated_pixel_values = vgetq_lane_u32(vreinterpretq_u32_u8(sums), 0);
+                pixels[1].concatenated_pixel_values = vgetq_lane_u32(vreinterpretq_u32_u8(sums), 1);
+                pixels[2].concatenated_pixel_values = vgetq_lane_u32(vreinterpretq_u32_u8(sums), 2);
+                pixels[3].concatenated_pixel_values = vgetq_lane_u32(vreinterpretq_u32_u8(sums), 3);
+#endif
+
+                /* Every pixel still goes into the running array */
+                for (lane = 0; lane < 4; lane++)
+                    dec->buffer[qoi_get_index_position(pixels[lane])] = pixels[lane];
+
+                dec->prev_pixel = pixels[3];
+                dec->pixel_seek += 4;
+                written += 4;
+
+                continue;
+            }
         }
+#endif
+
+        qoi_decode_op(dec);
 
-        dec->buffer[qoi_get_index_position(dec->prev_pixel)] = dec->prev_pixel;           
+        dec->pixel_seek++;
+        out[written++] = dec->prev_pixel.concatenated_pixel_values;
+    }
+
+    return written;
+}
+
+/*
+    Steps over up to max_pixels pixels without writing them and returns how many were passed
+    Every chunk is still read since the running array and the previous pixel depend on it,
+    but runs are stepped over as a count
+*/
+size_t qoi_skip_pixels(qoi_dec_t* dec, size_t max_pixels)
+{
+    size_t skipped = 0;
+
+    while (skipped < max_pixels)
+    {
+        if (dec->run > 0)
+        {
+            size_t count = max_pixels - skipped;
+
+            if (count > dec->run)
+                count = dec->run;
+            if (count > dec->img_area - dec->pixel_seek)
+                count = dec->img_area - dec->pixel_seek;
+            if (count == 0)
+                break;
+
+            dec->run -= count;
+            dec->pixel_seek += count;
+            skipped += count;
+
+            continue;
+        }
+
+        if (qoi_dec_done(dec))
+            break;
+
+        qoi_decode_op(dec);
+
+        dec->pixel_seek++;
+        skipped++;
+    }
+
+    return skipped;
+}
+
+/* Looks the color channels of a pixel up in a table such as QOI_SRGB_TO_LINEAR. Alpha is always linear */
+static inline qoi_pixel_t qoi_transfer_pixel(qoi_pixel_t px, const uint8_t* transfer)
+{
+    px.red = transfer[px.red];
+    px.green = transfer[px.green];
+    px.blue = transfer[px.blue];
+
+    return px;
+}
+
+/* Multiplies the colors of a pixel by its alpha, rounding c * a / 255 to the nearest value */
+static inline qoi_pixel_t qoi_premultiply(qoi_pixel_t px)
+{
+    uint32_t red, green, blue;
+
+    /* Most pixels of most images are opaque */
+    if (px.alpha == 255)
+        return px;
+
+    red = px.red * px.alpha + 128;
+    green = px.green * px.alpha + 128;
+    blue = px.blue * px.alpha + 128;
+
+    px.red = (uint8_t)((red + (red >> 8)) >> 8);
+    px.green = (uint8_t)((green + (green >> 8)) >> 8);
+    px.blue = (uint8_t)((blue + (blue >> 8)) >> 8);
+
+    return px;
+}
+
+/* Output format conversions used by the specialised span decoders */
+
+#define QOI_TO_RGBA32(px) ((px).concatenated_pixel_values)
+
+#define QOI_TO_RGBA16(px) ((uint16_t)( \
+    (((px).red >> 3) << 11) | \
+    (((px).green >> 3) << 6) | \
+    (((px).blue >> 3) << 1) | \
+    ((px).alpha >> 7)))
+
+#define QOI_TO_RGBA32_PREMULTIPLIED(px) QOI_TO_RGBA32(qoi_premultiply(px))
+
+#define QOI_TO_RGBA16_PREMULTIPLIED(px) QOI_TO_RGBA16(qoi_premultiply(px))
+
+/* Rec. 601 luma weights out of 256 */
+#define QOI_TO_I8(px) ((uint8_t)(((px).red * 77 + (px).green * 150 + (px).blue * 29) >> 8))
+
+#define QOI_TO_IA8(px) ((uint8_t)((QOI_TO_I8(px) & 0xF0) | ((px).alpha >> 4)))
+
+/* The same conversions after looking the color channels up in the table of the decoder */
+#define QOI_TRANSFER_TO_RGBA32(px) QOI_TO_RGBA32(qoi_transfer_pixel(px, dec->transfer))
+#define QOI_TRANSFER_TO_RGBA16(px) QOI_TO_RGBA16(qoi_transfer_pixel(px, dec->transfer))
+#define QOI_TRANSFER_TO_I8(px) QOI_TO_I8(qoi_transfer_pixel(px, dec->transfer))
+#define QOI_TRANSFER_TO_IA8(px) QOI_TO_IA8(qoi_transfer_pixel(px, dec->transfer))
+#define QOI_TRANSFER_TO_RGBA32_PREMULTIPLIED(px) QOI_TO_RGBA32_PREMULTIPLIED(qoi_transfer_pixel(px, dec->transfer))
+#define QOI_TRANSFER_TO_RGBA16_PREMULTIPLIED(px) QOI_TO_RGBA16_PREMULTIPLIED(qoi_transfer_pixel(px, dec->transfer))
+
+/*
+    Defines a span decoder specialised on the amount of channels of the image and the output format
+    so the loop has no per pixel checks of either. CONVERT may read the decoder through dec
+*/
+#define QOI_DEFINE_SPAN_DECODER(name, CHANNELS, OUT_TYPE, CONVERT, FILL) \
+    static size_t name(qoi_dec_t* dec, void* out_pixels, size_t max_pixels) \
+    { \
+        OUT_TYPE* out = (OUT_TYPE*)out_pixels; \
+        size_t written = 0; \
+        \
+        while (written < max_pixels) \
+        { \
+            if (dec->run > 0) \
+            { \
+                size_t count = max_pixels - written; \
+                OUT_TYPE value = CONVERT(dec->prev_pixel); \
+                \
+                if (count > dec->run) \
+                    count = dec->run; \
+                if (count > dec->img_area - dec->pixel_seek) \
+                    count = dec->img_area - dec->pixel_seek; \
+                if (count == 0) \
+                    break; \
+                \
+                QOI_PROFILE_START(clock); \
+                FILL(out + written, value, count); \
+                QOI_PROFILE_STOP(clock, QOI_PROFILE_FILL); \
+                \
+                dec->run -= count; \
+                dec->pixel_seek += count; \
+                written += count; \
+                \
+                continue; \
+            } \
+            \
+            if (qoi_dec_done(dec)) \
+                break; \
+            \
+            qoi_decode_op_channels(dec, CHANNELS); \
+            \
+            { \
+                QOI_PROFILE_START(clock); \
+                dec->pixel_seek++; \
+                out[written++] = CONVERT(dec->prev_pixel); \
+                QOI_PROFILE_STOP(clock, QOI_PROFILE_STORE); \
+            } \
+        } \
+        \
+        return written; \
+    }
+
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgb_rgba32, QOI_WHITESPACE, uint32_t, QOI_TO_RGBA32, qoi_fill_run)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgba_rgba32, QOI_TRANSPARENT, uint32_t, QOI_TO_RGBA32, qoi_fill_run)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgb_rgba16, QOI_WHITESPACE, uint16_t, QOI_TO_RGBA16, qoi_fill_run16)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgba_rgba16, QOI_TRANSPARENT, uint16_t, QOI_TO_RGBA16, qoi_fill_run16)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgb_i8, QOI_WHITESPACE, uint8_t, QOI_TO_I8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgba_i8, QOI_TRANSPARENT, uint8_t, QOI_TO_I8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgb_ia8, QOI_WHITESPACE, uint8_t, QOI_TO_IA8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgba_ia8, QOI_TRANSPARENT, uint8_t, QOI_TO_IA8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgba_rgba32_premultiplied, QOI_TRANSPARENT, uint32_t, QOI_TO_RGBA32_PREMULTIPLIED, qoi_fill_run)
+QOI_DEFINE_SPAN_DECODER(qoi_decode_span_rgba_rgba16_premultiplied, QOI_TRANSPARENT, uint16_t, QOI_TO_RGBA16_PREMULTIPLIED, qoi_fill_run16)
+
+/* Runs look their color up once so the table costs nothing for them */
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgb_rgba32, QOI_WHITESPACE, uint32_t, QOI_TRANSFER_TO_RGBA32, qoi_fill_run)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgba_rgba32, QOI_TRANSPARENT, uint32_t, QOI_TRANSFER_TO_RGBA32, qoi_fill_run)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgb_rgba16, QOI_WHITESPACE, uint16_t, QOI_TRANSFER_TO_RGBA16, qoi_fill_run16)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgba_rgba16, QOI_TRANSPARENT, uint16_t, QOI_TRANSFER_TO_RGBA16, qoi_fill_run16)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgb_i8, QOI_WHITESPACE, uint8_t, QOI_TRANSFER_TO_I8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgba_i8, QOI_TRANSPARENT, uint8_t, QOI_TRANSFER_TO_I8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgb_ia8, QOI_WHITESPACE, uint8_t, QOI_TRANSFER_TO_IA8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgba_ia8, QOI_TRANSPARENT, uint8_t, QOI_TRANSFER_TO_IA8, memset)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgba_rgba32_premultiplied, QOI_TRANSPARENT, uint32_t, QOI_TRANSFER_TO_RGBA32_PREMULTIPLIED, qoi_fill_run)
+QOI_DEFINE_SPAN_DECODER(qoi_transfer_span_rgba_rgba16_premultiplied, QOI_TRANSPARENT, uint16_t, QOI_TRANSFER_TO_RGBA16_PREMULTIPLIED, qoi_fill_run16)
+
+/* 
+    Picks the span decoder for an image once from its header so decoding never checks the format again
+    Returns NULL if the output format is unknown
+*/
+qoi_span_decoder_t qoi_select_span_decoder(uint8_t channels, uint8_t output_format)
+{
+    /* Premultiplying leaves opaque pixels as they are so RGB images share the plain decoders */
+    static const qoi_span_decoder_t decoders[2][QOI_OUTPUT_FORMATS] = {
+        {
+            qoi_decode_span_rgb_rgba32, qoi_decode_span_rgb_rgba16, qoi_decode_span_rgb_i8, qoi_decode_span_rgb_ia8,
+            qoi_decode_span_rgb_rgba32, qoi_decode_span_rgb_rgba16
+        },
+        {
+            qoi_decode_span_rgba_rgba32, qoi_decode_span_rgba_rgba16, qoi_decode_span_rgba_i8, qoi_decode_span_rgba_ia8,
+            qoi_decode_span_rgba_rgba32_premultiplied, qoi_decode_span_rgba_rgba16_premultiplied
+        }
+    };
+
+    if (output_format >= QOI_OUTPUT_FORMATS)
+        return NULL;
+
+    /* Anything that is not an RGB image may have alpha so it gets the general decoder */
+    return decoders[channels == QOI_WHITESPACE ? 0 : 1][output_format];
+}
+
+/*
+    Decodes only a rectangle of a QOI image into out, stride pixels from the start of one row to the next,
+    and returns how many rows of the rectangle were written. Pixels outside the rectangle are not written
+    and decoding stops right after the last row of the rectangle so the rest of the stream is never read.
+    A QOI-plus image cannot be decoded this way as undoing its row filters needs every row above.
+    The color channels are looked up in dec->transfer on the way if it is set
+
+    WARNING: the rectangle must lie inside the image and out must have room for its rows
+*/
+size_t qoi_decode_region(qoi_desc_t* desc, qoi_dec_t* dec, const qoi_region_t* region, void* out, size_t stride, uint8_t output_format)
+{
+    qoi_span_decoder_t span = dec->transfer ?
+        qoi_select_transfer_span_decoder(desc->channels, output_format) :
+        qoi_select_span_decoder(desc->channels, output_format);
+    size_t row_bytes, above, right;
+    size_t rows = 0;
+
+    if (!span || region->x + region->width > desc->width || region->y + region->height > desc->height)
+        return 0;
+
+    row_bytes = stride * QOI_OUTPUT_BYTES[output_format];
+    above = (size_t)region->y * desc->width;
+    right = desc->width - region->x - region->width;
+
+    /* Rows above the rectangle only move the decoder along */
+    if (qoi_skip_pixels(dec, above) < above)
+        return 0;
+
+    while (rows < region->height)
+    {
+        qoi_skip_pixels(dec, region->x);
+
+        if (span(dec, (uint8_t*)out + rows * row_bytes, region->width) < region->width)
+            break;
+
+        rows++;
+
+        /* Nothing past the end of the last row is read */
+        if (rows < region->height)
+            qoi_skip_pixels(dec, right);
+    }
+
+    return rows;
+}
+
+/*
+    Picks a span decoder like qoi_select_span_decoder() that also looks the color channels
+    of every pixel up in dec->transfer before converting them to the output format
+    Returns NULL if the output format is unknown
+*/
+qoi_span_decoder_t qoi_select_transfer_span_decoder(uint8_t channels, uint8_t output_format)
+{
+    static const qoi_span_decoder_t decoders[2][QOI_OUTPUT_FORMATS] = {
+        {
+            qoi_transfer_span_rgb_rgba32, qoi_transfer_span_rgb_rgba16, qoi_transfer_span_rgb_i8, qoi_transfer_span_rgb_ia8,
+            qoi_transfer_span_rgb_rgba32, qoi_transfer_span_rgb_rgba16
+        },
+        {
+            qoi_transfer_span_rgba_rgba32, qoi_transfer_span_rgba_rgba16, qoi_transfer_span_rgba_i8, qoi_transfer_span_rgba_ia8,
+            qoi_transfer_span_rgba_rgba32_premultiplied, qoi_transfer_span_rgba_rgba16_premultiplied
+        }
+    };
+
+    if (output_format >= QOI_OUTPUT_FORMATS)
+        return NULL;
+
+    return decoders[channels == QOI_WHITESPACE ? 0 : 1][output_format];
+}
+
+/* Converts a span of pixels with one conversion, looking the color channels up in transfer first if it is not NULL */
+#define QOI_CONVERT_SPAN(OUT_TYPE, CONVERT) \
+    if (transfer) \
+    { \
+        for (i = 0; i < count; i++) \
+            ((OUT_TYPE*)out)[i] = CONVERT(qoi_transfer_pixel(pixels[i], transfer)); \
+    } \
+    else \
+    { \
+        for (i = 0; i < count; i++) \
+            ((OUT_TYPE*)out)[i] = CONVERT(pixels[i]); \
+    }
+
+/* Converts RGBA pixels to an output format, checking the format once for the whole span */
+void qoi_convert_pixels(const qoi_pixel_t* pixels, void* out, size_t count, uint8_t output_format)
+{
+    qoi_convert_pixels_transfer(pixels, out, count, output_format, NULL);
+}
+
+/*
+    Converts RGBA pixels to an output format like qoi_convert_pixels(), looking the color channels
+    up in a table such as QOI_LINEAR_TO_SRGB on the way. The table may be NULL
+*/
+void qoi_convert_pixels_transfer(const qoi_pixel_t* pixels, void* out, size_t count, uint8_t output_format, const uint8_t* transfer)
+{
+    size_t i;
+
+    switch (output_format)
+    {
+        case QOI_OUTPUT_RGBA32:
+            QOI_CONVERT_SPAN(uint32_t, QOI_TO_RGBA32)
+            break;
+        case QOI_OUTPUT_RGBA16:
+            QOI_CONVERT_SPAN(uint16_t, QOI_TO_RGBA16)
+            break;
+        case QOI_OUTPUT_I8:
+            QOI_CONVERT_SPAN(uint8_t, QOI_TO_I8)
+            break;
+        case QOI_OUTPUT_IA8:
+            QOI_CONVERT_SPAN(uint8_t, QOI_TO_IA8)
+            break;
+        case QOI_OUTPUT_RGBA32_PREMULTIPLIED:
+            QOI_CONVERT_SPAN(uint32_t, QOI_TO_RGBA32_PREMULTIPLIED)
+            break;
+        case QOI_OUTPUT_RGBA16_PREMULTIPLIED:
+            QOI_CONVERT_SPAN(uint16_t, QOI_TO_RGBA16_PREMULTIPLIED)
+            break;
+        default:
+            break;
     }
-    
-    dec->pixel_seek++;
-    return dec->prev_pixel;
 }
 
 #ifdef __cplusplus
@@ -813,4 +1755,4 @@ qoi_pixel_t qoi_decode_chunk(qoi_dec_t* dec)
 
 #endif /* SIMPLIFIED_QOI_IMPLEMENTATION */
 
-#endif /* SIMPLIFIED_QOI_H_IMPLEMENTATION */
\ No newline at end of file
+#endif /* SIMPLIFIED_QOI_H_IMPLEMENTATION */
@@ -0,0 +1,290 @@
+/*
+
+    qoi_anim_pack.c
+
+    This file is a host tool that packs QOI files into a QOI animation
+    for the N64 QOI Viewer ROM
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+
+
+/// @file qoi_anim_pack.c
+/// @brief Host tool that packs QOI files into a QOI animation
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIMPLIFIED_QOI_IMPLEMENTATION
+#include "sQOI.h"
+
+/// @brief Size of the header of a QOI animation in bytes. Matches qoi_viewer.h
+#define QOI_ANIM_HEADER_SIZE 16
+
+/// @brief Size of the record in front of every frame in bytes. Matches qoi_viewer.h
+#define QOI_ANIM_FRAME_HEADER_SIZE 16
+
+/// @brief Reads a whole file into memory
+/// @param filename Name of the file
+/// @param size Size of the file in bytes
+/// @return Contents of the file or NULL if it cannot be read
+static uint8_t* read_file(const char* filename, size_t* size) {
+    FILE* fp = fopen(filename, "rb");
+    uint8_t* bytes;
+
+    if (!fp) {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    bytes = (uint8_t*)malloc(*size);
+
+    if (bytes && fread(bytes, 1, *size, fp) != *size) {
+        free(bytes);
+        bytes = NULL;
+    }
+
+    fclose(fp);
+    return bytes;
+}
+
+/// @brief Writes a big endian 16 bit value
+/// @param data Pointer to the first byte
+/// @param value Value in native byte order
+static void write_be16(uint8_t* data, uint16_t value) {
+    data[0] = value >> 8;
+    data[1] = value;
+}
+
+/// @brief Writes a big endian 32 bit value
+/// @param data Pointer to the first byte
+/// @param value Value in native byte order
+static void write_be32(uint8_t* data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+}
+
+/// @brief Decodes a QOI file into RGBA32 pixels
+/// @param filename Name of the QOI file
+/// @param desc QOI descriptor read from the header
+/// @return Pixels of the image or NULL if it cannot be decoded
+static uint32_t* load_frame(const char* filename, qoi_desc_t* desc) {
+    size_t size, area;
+    uint8_t* bytes = read_file(filename, &size);
+    uint32_t* pixels;
+    qoi_dec_t dec;
+
+    qoi_desc_init(desc);
+
+    if (!bytes || size < 14 || !read_qoi_header(desc, bytes)) {
+        free(bytes);
+        return NULL;
+    }
+
+    area = (size_t)desc->width * desc->height;
+    pixels = (uint32_t*)malloc(area * sizeof(uint32_t));
+
+    qoi_dec_init(desc, &dec, bytes, size);
+
+    if (!pixels || qoi_decode_span(&dec, pixels, area) != area) {
+        free(pixels);
+        pixels = NULL;
+    }
+
+    free(bytes);
+    return pixels;
+}
+
+/// @brief Finds the smallest area holding every pixel that changed between two frames
+/// @param prev Pixels of the frame before
+/// @param cur Pixels of the frame
+/// @param width Width of the canvas
+/// @param height Height of the canvas
+/// @param area Left, top, right and bottom edges of the area. Right and bottom are exclusive
+static void find_dirty_area(const uint32_t* prev, const uint32_t* cur, uint32_t width, uint32_t height, uint32_t area[4]) {
+    area[0] = width;
+    area[1] = height;
+    area[2] = 0;
+    area[3] = 0;
+
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            if (prev[y * width + x] != cur[y * width + x]) {
+                if (x < area[0]) area[0] = x;
+                if (y < area[1]) area[1] = y;
+                if (x + 1 > area[2]) area[2] = x + 1;
+                if (y + 1 > area[3]) area[3] = y + 1;
+            }
+        }
+    }
+
+    // a frame that changes nothing still has to hold one pixel
+    if (area[2] == 0) {
+        area[0] = area[1] = 0;
+        area[2] = area[3] = 1;
+    }
+}
+
+/// @brief Encodes an area of a frame as a QOI file
+/// @param frame Pixels of the frame
+/// @param stride Width of the canvas
+/// @param channels Number of channels to store
+/// @param area Left, top, right and bottom edges of the area
+/// @param out Memory for the QOI file
+/// @return Size of the QOI file in bytes
+static size_t encode_area(const uint32_t* frame, uint32_t stride, uint8_t channels, const uint32_t area[4], uint8_t* out) {
+    qoi_desc_t desc;
+    qoi_enc_t enc;
+
+    qoi_desc_init(&desc);
+    qoi_set_dimensions(&desc, area[2] - area[0], area[3] - area[1]);
+    qoi_set_channels(&desc, channels);
+    qoi_set_colorspace(&desc, QOI_SRGB);
+
+    write_qoi_header(&desc, out);
+    qoi_enc_init(&desc, &enc, out);
+
+    for (uint32_t y = area[1]; y < area[3]; y++) {
+        for (uint32_t x = area[0]; x < area[2]; x++) {
+            qoi_encode_chunk(&desc, &enc, (void*)&frame[y * stride + x]);
+        }
+    }
+
+    return enc.offset - out;
+}
+
+int main(int argc, char** argv) {
+    qoi_desc_t canvas, desc;
+    uint32_t* prev = NULL;
+    uint8_t header[QOI_ANIM_HEADER_SIZE];
+    uint8_t* out = NULL;
+    size_t total = QOI_ANIM_HEADER_SIZE, full_total = QOI_ANIM_HEADER_SIZE;
+    int delay, frame_count = argc - 3;
+    FILE* fp;
+
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s delay_ms output.qoia frame0.qoi [frame1.qoi ...]\n", argv[0]);
+        return 1;
+    }
+
+    qoi_desc_init(&canvas);
+    delay = atoi(argv[1]);
+
+    if (delay < 0 || delay > 65535) {
+        fprintf(stderr, "The delay has to be between 0 and 65535 ms\n");
+        return 1;
+    }
+
+    fp = fopen(argv[2], "wb");
+
+    if (!fp) {
+        fprintf(stderr, "Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    for (int frame = 0; frame < frame_count; frame++) {
+        uint32_t* cur = load_frame(argv[3 + frame], &desc);
+        uint8_t record[QOI_ANIM_FRAME_HEADER_SIZE];
+        uint32_t area[4] = {0, 0, desc.width, desc.height};
+        size_t size;
+
+        if (!cur) {
+            fprintf(stderr, "%s is not a QOI file\n", argv[3 + frame]);
+            return 1;
+        }
+
+        if (frame == 0) {
+            canvas = desc;
+
+            if (canvas.width > 65535 || canvas.height > 65535) {
+                fprintf(stderr, "%s is too big for a QOI animation\n", argv[3]);
+                return 1;
+            }
+
+            memcpy(header, "qoia", 4);
+            write_be32(&header[4], canvas.width);
+            write_be32(&header[8], canvas.height);
+            write_be32(&header[12], frame_count);
+            fwrite(header, 1, QOI_ANIM_HEADER_SIZE, fp);
+
+            // the worst case is an RGBA chunk for every pixel
+            out = (uint8_t*)malloc(14 + (size_t)canvas.width * canvas.height * 5 + 8);
+
+            if (!out) {
+                fprintf(stderr, "Out of memory\n");
+                return 1;
+            }
+        }
+        else if (desc.width != canvas.width || desc.height != canvas.height) {
+            fprintf(stderr, "%s is not the same size as %s\n", argv[3 + frame], argv[3]);
+            return 1;
+        }
+        else {
+            // the first frame covers the whole canvas so the animation can loop back to it
+            find_dirty_area(prev, cur, canvas.width, canvas.height, area);
+        }
+
+        size = encode_area(cur, canvas.width, canvas.channels, area, out);
+
+        write_be16(&record[0], area[0]);
+        write_be16(&record[2], area[1]);
+        write_be16(&record[4], area[2] - area[0]);
+        write_be16(&record[6], area[3] - area[1]);
+        write_be16(&record[8], delay);
+        write_be16(&record[10], 0);
+        write_be32(&record[12], size);
+
+        fwrite(record, 1, QOI_ANIM_FRAME_HEADER_SIZE, fp);
+        fwrite(out, 1, size, fp);
+
+        printf("frame %i: %u x %u at %u, %u, %zu bytes\n", frame, area[2] - area[0], area[3] - area[1], area[0], area[1], size);
+
+        total += QOI_ANIM_FRAME_HEADER_SIZE + size;
+
+        // the size of every frame stored whole is reported to compare against
+        if (frame > 0) {
+            uint32_t whole[4] = {0, 0, canvas.width, canvas.height};
+            size = encode_area(cur, canvas.width, canvas.channels, whole, out);
+        }
+
+        full_total += QOI_ANIM_FRAME_HEADER_SIZE + size;
+
+
+        free(prev);
+        prev = cur;
+    }
+
+    fclose(fp);
+
+    printf("%s: %i frames, %zu bytes (%zu bytes as whole frames)\n", argv[2], frame_count, total, full_total);
+
+    return 0;
+}
@@ -0,0 +1,738 @@
+/*
+
+    qoi_check.c
+
+    This file is a host tool that checks every decoder of the N64 QOI Viewer
+    ROM gives the same image and measures how fast each one is
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+
+
+/// @file qoi_check.c
+/// @brief Host tool that checks every decoder gives the same image and measures how fast each one is
+/// @details Each QOI file is decoded one pixel at a time with qoi_decode_chunk() and the result is what
+/// the other decoders are compared against. The image is also encoded again at every effort level and
+/// decoded back, as are small images ending in runs. Files are also decoded a row at a time as they land in pieces. Checksums of the images and the decoding speeds can be saved and compared on later runs
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIMPLIFIED_QOI_IMPLEMENTATION
+#include "sQOI.h"
+
+/// @brief Pixels decoded per call by the bounded decoders. Odd so slices end in the middle of runs
+#define SLICE_PIXELS 61
+
+/// @brief Sizes of the pieces the streaming decoder gets the file in, used over and over
+/// @details Uneven so pieces end in the middle of chunks and rows, starting with a header that lands a few bytes at a time
+static const size_t STREAM_PIECES[] = {1, 5, 11, 64, 3, 509, 17, 250, 2, 1021};
+
+/// @brief Most bytes a QOI chunk takes for one pixel. Rows are decoded once this many bytes per pixel have landed as in the viewer
+#define STREAM_BYTES_PER_PIXEL 5
+
+/// @brief Most files checked in one run
+#define MAX_FILES 256
+
+/// @brief Decoders that are timed
+enum decoder {
+    DECODER_CHUNK, ///< qoi_decode_chunk() for every pixel
+    DECODER_SPAN, ///< qoi_decode_span() for the whole image at once
+    DECODER_BOUNDED, ///< qoi_decode_span() a slice at a time as the viewer does within its time budget
+    DECODER_STREAM, ///< The span decoder picked for RGBA32 output a row at a time as the file lands in uneven pieces
+    DECODER_RGBA32, ///< The span decoder picked for RGBA32 output a slice at a time
+    DECODER_RGBA16, ///< The span decoder picked for RGBA16 output a slice at a time
+    DECODERS
+};
+
+/// @brief Names of the decoders in the report and the baseline file
+static const char* decoder_names[DECODERS] = {"chunk", "span", "bounded", "stream", "rgba32", "rgba16"};
+
+/// @brief Names of the encoder effort levels. See enum qoi_effort
+static const char* effort_names[] = {"default", "fast"};
+
+/// @brief A checksum read from or written to the checksum file
+typedef struct checksum {
+    /// @brief Checksum of the RGBA32 pixels
+    uint64_t hash;
+
+    /// @brief Name of the file without its directory
+    char name[256];
+} checksum_t;
+
+/// @brief Seconds spent and pixels decoded by each decoder over all files
+static double decoder_seconds[DECODERS];
+static double decoder_pixels[DECODERS];
+
+/// @brief Reads a whole file into memory
+/// @param filename Name of the file
+/// @param size Size of the file in bytes
+/// @return Contents of the file or NULL if it cannot be read
+static uint8_t* read_file(const char* filename, size_t* size) {
+    FILE* fp = fopen(filename, "rb");
+    uint8_t* bytes;
+
+    if (!fp) {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    bytes = (uint8_t*)malloc(*size);
+
+    if (bytes && fread(bytes, 1, *size, fp) != *size) {
+        free(bytes);
+        bytes = NULL;
+    }
+
+    fclose(fp);
+    return bytes;
+}
+
+/// @brief Reads the host clock
+/// @return Seconds since some point in the past
+static double now_seconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief Hashes bytes with 64 bit FNV-1a
+/// @param bytes Bytes to hash
+/// @param size Number of bytes
+/// @return Hash of the bytes
+static uint64_t fnv1a(const void* bytes, size_t size) {
+    const uint8_t* p = (const uint8_t*)bytes;
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ p[i]) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+/// @brief Gets the name of a file without its directory
+/// @param path Path of the file
+/// @return Name of the file
+static const char* base_name(const char* path) {
+    const char* slash = strrchr(path, '/');
+
+    return slash ? slash + 1 : path;
+}
+
+/// @brief Decodes a file a row at a time while it lands in memory in pieces, the way the viewer decodes files read with PI DMA
+/// @details Bytes that have not landed yet hold garbage so reading one of them changes the image
+/// @param desc QOI descriptor of the image
+/// @param bytes QOI file
+/// @param size Size of the QOI file in bytes
+/// @param out Memory for the decoded image, 4 bytes per pixel
+/// @return Number of pixels written
+static size_t decode_stream(qoi_desc_t* desc, uint8_t* bytes, size_t size, uint32_t* out) {
+    qoi_span_decoder_t span = qoi_select_span_decoder(desc->channels, QOI_OUTPUT_RGBA32);
+    size_t row_bytes = (size_t)desc->width * STREAM_BYTES_PER_PIXEL;
+    uint8_t* landing = (uint8_t*)malloc(size);
+    size_t landed = 0, written = 0;
+    int piece = 0;
+    qoi_dec_t dec;
+
+    if (!landing) {
+        return 0;
+    }
+
+    memset(landing, 0xA5, size);
+    qoi_dec_init(desc, &dec, landing, size);
+
+    for (uint32_t y = 0; y < desc->height; y++) {
+        // the row waits for enough bytes to land unless the whole file is in
+        while (landed < size && landed < (size_t)(dec.offset - landing) + row_bytes) {
+            size_t count = STREAM_PIECES[piece++ % (sizeof(STREAM_PIECES) / sizeof(STREAM_PIECES[0]))];
+
+            count = count < size - landed ? count : size - landed;
+            memcpy(landing + landed, bytes + landed, count);
+            landed += count;
+        }
+
+        if (span(&dec, out + written, desc->width) < desc->width) {
+            break;
+        }
+
+        written += desc->width;
+    }
+
+    free(landing);
+    return written;
+}
+
+/// @brief Decodes a file with one of the decoders
+/// @param which Decoder to use
+/// @param desc QOI descriptor of the image
+/// @param bytes QOI file
+/// @param size Size of the QOI file in bytes
+/// @param out Memory for the decoded image, 4 bytes per pixel
+/// @return Number of pixels written
+static size_t decode(enum decoder which, qoi_desc_t* desc, uint8_t* bytes, size_t size, void* out) {
+    size_t area = (size_t)desc->width * desc->height;
+    size_t written = 0;
+    uint8_t format = QOI_OUTPUT_RGBA32;
+    qoi_span_decoder_t span;
+    qoi_dec_t dec;
+
+    qoi_dec_init(desc, &dec, bytes, size);
+
+    switch (which) {
+        case DECODER_CHUNK:
+            while (!qoi_dec_done(&dec)) {
+                ((qoi_pixel_t*)out)[written++] = qoi_decode_chunk(&dec);
+            }
+            return written;
+        case DECODER_SPAN:
+            return qoi_decode_span(&dec, (uint32_t*)out, area);
+        case DECODER_BOUNDED:
+            while (written < area) {
+                size_t count = qoi_decode_span(&dec, (uint32_t*)out + written, area - written < SLICE_PIXELS ? area - written : SLICE_PIXELS);
+
+                if (count == 0) {
+                    break;
+                }
+
+                written += count;
+            }
+            return written;
+        case DECODER_STREAM:
+            return decode_stream(desc, bytes, size, (uint32_t*)out);
+        case DECODER_RGBA32:
+            break;
+        case DECODER_RGBA16:
+            format = QOI_OUTPUT_RGBA16;
+            break;
+        default:
+            return 0;
+    }
+
+    span = qoi_select_span_decoder(desc->channels, format);
+
+    while (written < area) {
+        size_t count = span(&dec, (uint8_t*)out + written * QOI_OUTPUT_BYTES[format], area - written < SLICE_PIXELS ? area - written : SLICE_PIXELS);
+
+        if (count == 0) {
+            break;
+        }
+
+        written += count;
+    }
+
+    return written;
+}
+
+/// @brief Checks every output format of the span decoders against the reference image
+/// @param desc QOI descriptor of the image
+/// @param bytes QOI file
+/// @param size Size of the QOI file in bytes
+/// @param reference Image decoded one pixel at a time
+/// @param out Memory for the decoded image, 4 bytes per pixel
+/// @param expected Memory for the reference image converted to an output format, 4 bytes per pixel
+/// @param transfer Table for the transfer span decoders to look colors up in or NULL for the plain span decoders
+/// @return Number of output formats that did not match
+static int check_output_formats(qoi_desc_t* desc, uint8_t* bytes, size_t size, qoi_pixel_t* reference, uint8_t* out, uint8_t* expected, const uint8_t* transfer) {
+    size_t area = (size_t)desc->width * desc->height;
+    int failures = 0;
+
+    for (uint8_t format = 0; format < QOI_OUTPUT_FORMATS; format++) {
+        qoi_span_decoder_t span = transfer ? qoi_select_transfer_span_decoder(desc->channels, format) : qoi_select_span_decoder(desc->channels, format);
+        size_t written = 0;
+        qoi_dec_t dec;
+
+        qoi_dec_init(desc, &dec, bytes, size);
+        dec.transfer = transfer;
+
+        while (written < area) {
+            size_t count = span(&dec, out + written * QOI_OUTPUT_BYTES[format], area - written < SLICE_PIXELS ? area - written : SLICE_PIXELS);
+
+            if (count == 0) {
+                break;
+            }
+
+            written += count;
+        }
+
+        qoi_convert_pixels_transfer(reference, expected, area, format, transfer);
+
+        if (written != area || memcmp(out, expected, area * QOI_OUTPUT_BYTES[format]) != 0) {
+            printf("  output format %d%s does not match\n", format, transfer ? " with a transfer table" : "");
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+/// @brief Decodes rectangles of the image on their own and checks they match the same area of the reference image
+/// @param desc QOI descriptor of the image
+/// @param bytes QOI file
+/// @param size Size of the QOI file in bytes
+/// @param reference Image decoded one pixel at a time
+/// @param out Memory for the decoded rectangle, 4 bytes per pixel of the image
+/// @param expected Memory for a row of the reference image looked up in the transfer table, 4 bytes per pixel of a row
+/// @param transfer Table for the decoder to look colors up in or NULL
+/// @return Number of rectangles that did not match
+static int check_regions(qoi_desc_t* desc, uint8_t* bytes, size_t size, qoi_pixel_t* reference, uint32_t* out, uint32_t* expected, const uint8_t* transfer) {
+    uint32_t w = desc->width, h = desc->height;
+    // the corners, the middle and a single pixel catch runs crossing the edges of a rectangle
+    qoi_region_t regions[] = {
+        {0, 0, w, h},
+        {0, 0, (w + 1) / 2, (h + 1) / 2},
+        {w / 4, h / 4, (w + 1) / 2, (h + 1) / 2},
+        {w / 2, h / 2, w - w / 2, h - h / 2},
+        {0, h - 1, w, 1},
+        {w - 1, h - 1, 1, 1}
+    };
+    int failures = 0;
+
+    for (size_t r = 0; r < sizeof(regions) / sizeof(regions[0]); r++) {
+        const qoi_region_t* region = &regions[r];
+        size_t rows;
+        qoi_dec_t dec;
+
+        qoi_dec_init(desc, &dec, bytes, size);
+        dec.transfer = transfer;
+
+        rows = qoi_decode_region(desc, &dec, region, out, region->width, QOI_OUTPUT_RGBA32);
+
+        for (uint32_t y = 0; y < rows; y++) {
+            qoi_convert_pixels_transfer(&reference[(region->y + y) * w + region->x], expected, region->width, QOI_OUTPUT_RGBA32, transfer);
+
+            if (memcmp(&out[y * region->width], expected, region->width * sizeof(uint32_t)) != 0) {
+                rows = 0;
+                break;
+            }
+        }
+
+        if (rows != region->height) {
+            printf("  region %ux%u at %u,%u%s does not match\n", region->width, region->height, region->x, region->y, transfer ? " with a transfer table" : "");
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+/// @brief Encodes an image
+/// @param desc QOI descriptor of the image
+/// @param pixels Pixels of the image
+/// @param effort Effort level of the encoder. See enum qoi_effort
+/// @param encoded Memory for the QOI file, at least 14 + 5 bytes per pixel + 8 bytes
+/// @return Size of the QOI file in bytes
+static size_t encode(qoi_desc_t* desc, qoi_pixel_t* pixels, uint8_t effort, uint8_t* encoded) {
+    size_t area = (size_t)desc->width * desc->height;
+    qoi_enc_t enc;
+
+    write_qoi_header(desc, encoded);
+    qoi_enc_init(desc, &enc, encoded);
+    qoi_enc_set_effort(&enc, effort);
+
+    for (size_t i = 0; i < area; i++) {
+        qoi_encode_chunk(desc, &enc, &pixels[i]);
+    }
+
+    return enc.offset - encoded;
+}
+
+/// @brief Encodes the reference image at every effort level and checks it decodes back the same
+/// @param desc QOI descriptor of the image
+/// @param reference Image decoded one pixel at a time
+/// @param out Memory for the decoded image, 4 bytes per pixel
+/// @return Number of effort levels that did not give the same image back
+static int check_round_trips(qoi_desc_t* desc, qoi_pixel_t* reference, uint32_t* out) {
+    size_t area = (size_t)desc->width * desc->height;
+    // the worst case is an RGBA chunk for every pixel
+    size_t capacity = 14 + area * 5 + 8;
+    uint8_t* encoded = (uint8_t*)malloc(capacity);
+    int failures = 0;
+
+    if (!encoded) {
+        printf("  out of memory for the round trip\n");
+        return 1;
+    }
+
+    for (uint8_t effort = 0; effort < sizeof(effort_names) / sizeof(effort_names[0]); effort++) {
+        size_t size = encode(desc, reference, effort, encoded);
+
+        if (decode(DECODER_SPAN, desc, encoded, size, out) != area || memcmp(out, reference, area * sizeof(uint32_t)) != 0) {
+            printf("  %s effort encoding does not decode back to the same image\n", effort_names[effort]);
+            failures++;
+        }
+    }
+
+    free(encoded);
+    return failures;
+}
+
+/// @brief Encodes images ending in runs of different lengths and checks the last run is written before the padding
+/// @details The encoder once left a run that reached the last pixel unwritten, so the decoder read the padding as pixels
+/// @return Number of images and effort levels that failed
+static int check_trailing_runs(void) {
+    // runs of one pixel, just below, at and just above the longest run chunk, two full run chunks and a whole image
+    static const uint32_t run_lengths[] = {1, 2, 61, 62, 63, 124, 125, 0};
+    static qoi_pixel_t pixels[256];
+    static uint8_t encoded[14 + 256 * 5 + 8];
+    static uint32_t out[256];
+    int failures = 0;
+
+    for (size_t t = 0; t < sizeof(run_lengths) / sizeof(run_lengths[0]); t++) {
+        // the first pixel of an image matches the previous pixel the encoder starts with, so a whole image is one run
+        uint32_t run = run_lengths[t] ? run_lengths[t] : 100;
+        uint32_t lead = run_lengths[t] ? 6 : 0;
+        qoi_desc_t desc;
+
+        qoi_desc_init(&desc);
+        qoi_set_dimensions(&desc, lead + run, 1);
+        qoi_set_channels(&desc, 4);
+        qoi_set_colorspace(&desc, QOI_SRGB);
+
+        // the last pixel before the run has the color of the run
+        for (uint32_t i = 0; i + 1 < lead; i++) {
+            pixels[i] = (qoi_pixel_t){.red = (uint8_t)(i * 40), .green = (uint8_t)(255 - i * 30), .blue = (uint8_t)(i * 7), .alpha = 255};
+        }
+
+        for (uint32_t i = lead ? lead - 1 : 0; i < lead + run; i++) {
+            pixels[i] = lead ? (qoi_pixel_t){.red = 200, .green = 10, .blue = 10, .alpha = 255} : (qoi_pixel_t){.alpha = 255};
+        }
+
+        for (uint8_t effort = 0; effort < sizeof(effort_names) / sizeof(effort_names[0]); effort++) {
+            size_t size = encode(&desc, pixels, effort, encoded);
+
+            uint8_t last_chunk = encoded[size - 9];
+
+            if (last_chunk < QOI_OP_RUN || last_chunk >= QOI_OP_RGB ||
+                decode(DECODER_SPAN, &desc, encoded, size, out) != lead + run ||
+                memcmp(out, pixels, (lead + run) * sizeof(uint32_t)) != 0
+            ) {
+                printf("trailing run of %u pixels after %u: %s effort encoding does not decode back to the same image\n", run, lead, effort_names[effort]);
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
+
+/// @brief Times the decoders on a file, adding to the totals of every decoder
+/// @param desc QOI descriptor of the image
+/// @param bytes QOI file
+/// @param size Size of the QOI file in bytes
+/// @param out Memory for the decoded image, 4 bytes per pixel
+/// @param repeats Times each decoder decodes the file
+static void time_decoders(qoi_desc_t* desc, uint8_t* bytes, size_t size, void* out, int repeats) {
+    size_t area = (size_t)desc->width * desc->height;
+
+    for (int which = 0; which < DECODERS; which++) {
+        double start = now_seconds();
+
+        for (int r = 0; r < repeats; r++) {
+            decode((enum decoder)which, desc, bytes, size, out);
+        }
+
+        decoder_seconds[which] += now_seconds() - start;
+        decoder_pixels[which] += (double)area * repeats;
+    }
+}
+
+/// @brief Reads a checksum file
+/// @param filename Name of the checksum file
+/// @param sums Checksums read
+/// @return Number of checksums read or -1 if the file cannot be read
+static int read_checksums(const char* filename, checksum_t* sums) {
+    FILE* fp = fopen(filename, "r");
+    char line[512];
+    int count = 0;
+
+    if (!fp) {
+        return -1;
+    }
+
+    while (count < MAX_FILES && fgets(line, sizeof(line), fp)) {
+        unsigned long long hash;
+
+        if (sscanf(line, "%llx %255s", &hash, sums[count].name) == 2) {
+            sums[count++].hash = hash;
+        }
+    }
+
+    fclose(fp);
+    return count;
+}
+
+/// @brief Reads decoding speeds from a baseline file
+/// @param filename Name of the baseline file
+/// @param speeds Megapixels per second of each decoder. Decoders not in the file are left at 0
+/// @return true if the file was read
+static bool read_baseline(const char* filename, double* speeds) {
+    FILE* fp = fopen(filename, "r");
+    char line[256];
+
+    if (!fp) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        char name[32];
+        double speed;
+
+        if (sscanf(line, "%31s %lf", name, &speed) != 2) {
+            continue;
+        }
+
+        for (int which = 0; which < DECODERS; which++) {
+            if (strcmp(name, decoder_names[which]) == 0) {
+                speeds[which] = speed;
+            }
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
+
+/// @brief Prints how to use the tool
+/// @param name Name of the program
+static void usage(const char* name) {
+    fprintf(
+        stderr,
+        "usage: %s [-c checksums] [-C checksums] [-b baseline] [-B baseline] [-t percent] [-r repeats] file.qoi ...\n"
+        "  -c  compare the decoded images against a checksum file\n"
+        "  -C  write the checksums of the decoded images to a file\n"
+        "  -b  fail if a decoder is slower than in a baseline file by more than the threshold\n"
+        "  -B  write the decoding speeds to a baseline file\n"
+        "  -t  threshold in percent for -b, 10 by default\n"
+        "  -r  times each decoder decodes each file when timing, 20 by default\n",
+        name
+    );
+}
+
+int main(int argc, char** argv) {
+    const char *check_sums = NULL, *write_sums = NULL, *check_base = NULL, *write_base = NULL;
+    static checksum_t expected_sums[MAX_FILES];
+    int num_expected = 0, failures = 0, checked = 0, repeats = 20;
+    double threshold = 10.0;
+    FILE* sums_out = NULL;
+    int i;
+
+    for (i = 1; i < argc - 1 && argv[i][0] == '-'; i += 2) {
+        switch (argv[i][1]) {
+            case 'c':
+                check_sums = argv[i + 1];
+                break;
+            case 'C':
+                write_sums = argv[i + 1];
+                break;
+            case 'b':
+                check_base = argv[i + 1];
+                break;
+            case 'B':
+                write_base = argv[i + 1];
+                break;
+            case 't':
+                threshold = atof(argv[i + 1]);
+                break;
+            case 'r':
+                repeats = atoi(argv[i + 1]);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (i >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (check_sums && (num_expected = read_checksums(check_sums, expected_sums)) < 0) {
+        fprintf(stderr, "Cannot read %s\n", check_sums);
+        return 1;
+    }
+
+    if (write_sums && !(sums_out = fopen(write_sums, "w"))) {
+        fprintf(stderr, "Cannot write %s\n", write_sums);
+        return 1;
+    }
+
+    failures += check_trailing_runs();
+
+    for (; i < argc; i++) {
+        const char* name = base_name(argv[i]);
+        size_t size, area;
+        uint8_t* bytes = read_file(argv[i], &size);
+        qoi_pixel_t* reference;
+        uint8_t *out, *expected;
+        qoi_desc_t desc;
+        uint64_t hash, stream_hash;
+        int file_failures = 0;
+
+        qoi_desc_init(&desc);
+
+        // QOI-plus, QOI-LZ and animation files are checked by the tools that make them
+        if (!bytes || size < 22 || !read_qoi_header(&desc, bytes)) {
+            printf("%s: skipped, not a QOI file\n", name);
+            free(bytes);
+            continue;
+        }
+
+        area = (size_t)desc.width * desc.height;
+        reference = (qoi_pixel_t*)malloc(area * sizeof(qoi_pixel_t));
+        out = (uint8_t*)malloc(area * sizeof(uint32_t));
+        expected = (uint8_t*)malloc(area * sizeof(uint32_t));
+
+        if (!reference || !out || !expected) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+
+        if (decode(DECODER_CHUNK, &desc, bytes, size, reference) != area) {
+            printf("%s: truncated\n", name);
+            file_failures++;
+        }
+        else {
+            for (int which = DECODER_SPAN; which <= DECODER_RGBA32; which++) {
+                if (decode((enum decoder)which, &desc, bytes, size, out) != area || memcmp(out, reference, area * sizeof(uint32_t)) != 0) {
+                    printf("%s: %s decoder does not match\n", name, decoder_names[which]);
+                    file_failures++;
+                }
+            }
+
+            file_failures += check_output_formats(&desc, bytes, size, reference, out, expected, NULL);
+            file_failures += check_output_formats(&desc, bytes, size, reference, out, expected, QOI_SRGB_TO_LINEAR);
+            file_failures += check_regions(&desc, bytes, size, reference, (uint32_t*)out, (uint32_t*)expected, NULL);
+            file_failures += check_regions(&desc, bytes, size, reference, (uint32_t*)out, (uint32_t*)expected, QOI_SRGB_TO_LINEAR);
+            file_failures += check_round_trips(&desc, reference, (uint32_t*)out);
+        }
+
+        hash = fnv1a(reference, area * sizeof(qoi_pixel_t));
+
+        // the image streamed in pieces is held to the checksum on its own as well as to the reference image
+        stream_hash = decode(DECODER_STREAM, &desc, bytes, size, out) == area ? fnv1a(out, area * sizeof(uint32_t)) : 0;
+
+        if (sums_out) {
+            fprintf(sums_out, "%016llx %s\n", (unsigned long long)hash, name);
+        }
+
+        if (check_sums) {
+            int found = 0;
+
+            for (int s = 0; s < num_expected; s++) {
+                if (strcmp(expected_sums[s].name, name) == 0) {
+                    found = 1;
+
+                    if (expected_sums[s].hash != hash) {
+                        printf("%s: checksum %016llx does not match %016llx\n", name, (unsigned long long)hash, (unsigned long long)expected_sums[s].hash);
+                        file_failures++;
+                    }
+
+                    if (expected_sums[s].hash != stream_hash) {
+                        printf("%s: streamed checksum %016llx does not match %016llx\n", name, (unsigned long long)stream_hash, (unsigned long long)expected_sums[s].hash);
+                        file_failures++;
+                    }
+                }
+            }
+
+            if (!found) {
+                printf("%s: no checksum in %s\n", name, check_sums);
+            }
+        }
+
+        if (file_failures == 0) {
+            time_decoders(&desc, bytes, size, out, repeats);
+            printf("%s: %ux%u, %d channels, ok\n", name, desc.width, desc.height, desc.channels);
+        }
+
+        failures += file_failures;
+        checked++;
+
+        free(expected);
+        free(out);
+        free(reference);
+        free(bytes);
+    }
+
+    if (sums_out) {
+        fclose(sums_out);
+    }
+
+    if (checked > 0 && failures == 0) {
+        double baseline[DECODERS] = {0};
+        FILE* base_out = NULL;
+
+        if (check_base && !read_baseline(check_base, baseline)) {
+            fprintf(stderr, "Cannot read %s\n", check_base);
+            return 1;
+        }
+
+        if (write_base && !(base_out = fopen(write_base, "w"))) {
+            fprintf(stderr, "Cannot write %s\n", write_base);
+            return 1;
+        }
+
+        printf("\n%-8s %10s %10s\n", "decoder", "MP/s", "baseline");
+
+        for (int which = 0; which < DECODERS; which++) {
+            double speed = decoder_pixels[which] / decoder_seconds[which] / 1e6;
+
+            printf("%-8s %10.1f", decoder_names[which], speed);
+
+            if (baseline[which] > 0.0) {
+                double change = (speed / baseline[which] - 1.0) * 100.0;
+
+                printf(" %10.1f %+.1f%%", baseline[which], change);
+
+                if (change < -threshold) {
+                    printf(" slower than the baseline");
+                    failures++;
+                }
+            }
+
+            printf("\n");
+
+            if (base_out) {
+                fprintf(base_out, "%s %.1f\n", decoder_names[which], speed);
+            }
+        }
+
+        if (base_out) {
+            fclose(base_out);
+        }
+    }
+
+    printf("\n%d files checked, %d failures\n", checked, failures);
+
+    return failures > 0;
+}
@@ -0,0 +1,273 @@
+/*
+
+    qoi_lz_pack.c
+
+    This file is a host tool that wraps QOI and QOI-plus files in a
+    QOI-LZ container for the N64 QOI Viewer ROM
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+
+
+/// @file qoi_lz_pack.c
+/// @brief Host tool that wraps QOI and QOI-plus files in a QOI-LZ container
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qoi_lz.h"
+
+/// @brief Bits of the hash used to find matches
+#define HASH_BITS 14
+
+/// @brief Furthest a match can reach back in the LZ4 block format
+#define MAX_OFFSET 65535
+
+/// @brief Reads a whole file into memory
+/// @param filename Name of the file
+/// @param size Size of the file in bytes
+/// @return Contents of the file or NULL if it cannot be read
+static uint8_t* read_file(const char* filename, size_t* size) {
+    FILE* fp = fopen(filename, "rb");
+    uint8_t* bytes;
+
+    if (!fp) {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    bytes = (uint8_t*)malloc(*size);
+
+    if (bytes && fread(bytes, 1, *size, fp) != *size) {
+        free(bytes);
+        bytes = NULL;
+    }
+
+    fclose(fp);
+    return bytes;
+}
+
+/// @brief Writes a big endian 32 bit value
+/// @param data Pointer to the first byte
+/// @param value Value in native byte order
+static void write_be32(uint8_t* data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+}
+
+/// @brief Hashes the four bytes at a position to find earlier matches
+/// @param data Pointer to the four bytes
+/// @return Slot in the hash table
+static uint32_t hash4(const uint8_t* data) {
+    uint32_t value;
+
+    memcpy(&value, data, 4);
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/// @brief Writes a length of the LZ4 block format that does not fit in the token
+/// @param op Write position. Moved past the extra bytes
+/// @param length Length minus the 15 stored in the token
+static void write_length(uint8_t** op, uint32_t length) {
+    while (length >= 255) {
+        *(*op)++ = 255;
+        length -= 255;
+    }
+
+    *(*op)++ = length;
+}
+
+/// @brief Writes one LZ4 sequence
+/// @param op Write position. Moved past the sequence
+/// @param literals Literals in front of the match
+/// @param literal_length Number of literals
+/// @param offset Distance back to the match or 0 for the literals at the end of a block
+/// @param match_length Length of the match
+static void write_sequence(uint8_t** op, const uint8_t* literals, uint32_t literal_length, uint32_t offset, uint32_t match_length) {
+    uint8_t* token = (*op)++;
+    uint32_t match_code = offset ? match_length - 4 : 0;
+
+    *token = (literal_length < 15 ? literal_length : 15) << 4;
+
+    if (literal_length >= 15) {
+        write_length(op, literal_length - 15);
+    }
+
+    memcpy(*op, literals, literal_length);
+    *op += literal_length;
+
+    if (!offset) {
+        return;
+    }
+
+    *(*op)++ = offset & 0xFF;
+    *(*op)++ = offset >> 8;
+
+    *token |= match_code < 15 ? match_code : 15;
+
+    if (match_code >= 15) {
+        write_length(op, match_code - 15);
+    }
+}
+
+/// @brief Compresses one block. Matches may reach back into earlier blocks
+/// @param data Whole file being wrapped
+/// @param start Offset of the block in the file
+/// @param end Offset of the end of the block in the file
+/// @param table Hash table of the last position of every hash. Carried between blocks
+/// @param out Memory for the compressed block
+/// @return Size of the compressed block in bytes
+static size_t compress_block(const uint8_t* data, size_t start, size_t end, long* table, uint8_t* out) {
+    uint8_t* op = out;
+    size_t anchor = start;
+    size_t pos = start;
+
+    while (pos + 4 <= end) {
+        uint32_t slot = hash4(&data[pos]);
+        long candidate = table[slot];
+        size_t length;
+
+        table[slot] = pos;
+
+        if (candidate < 0 || pos - candidate > MAX_OFFSET || memcmp(&data[candidate], &data[pos], 4) != 0) {
+            pos++;
+            continue;
+        }
+
+        length = 4;
+
+        while (pos + length < end && data[candidate + length] == data[pos + length]) {
+            length++;
+        }
+
+        write_sequence(&op, &data[anchor], pos - anchor, pos - candidate, length);
+
+        // every position inside the match is hashed so later matches can find it
+        for (size_t skipped = pos + 1; skipped < pos + length && skipped + 4 <= end; skipped++) {
+            table[hash4(&data[skipped])] = skipped;
+        }
+
+        pos += length;
+        anchor = pos;
+    }
+
+    write_sequence(&op, &data[anchor], end - anchor, 0, 0);
+
+    return op - out;
+}
+
+int main(int argc, char** argv) {
+    size_t size, packed_size = QOI_LZ_HEADER_SIZE;
+    uint8_t* data;
+    uint8_t* out;
+    uint8_t* check;
+    long* table;
+    FILE* fp;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s input.qoi output.qoiz\n", argv[0]);
+        return 1;
+    }
+
+    data = read_file(argv[1], &size);
+
+    if (!data || size < 14 || memcmp(data, "qoi", 3) != 0 || (data[3] != 'f' && data[3] != 'p')) {
+        fprintf(stderr, "%s is not a QOI or QOI-plus file\n", argv[1]);
+        return 1;
+    }
+
+    // a block is stored as is when it does not get smaller so it never grows past the block header
+    out = (uint8_t*)malloc(QOI_LZ_HEADER_SIZE + size + (size / QOI_LZ_BLOCK_SIZE + 1) * (QOI_LZ_BLOCK_HEADER_SIZE + QOI_LZ_BLOCK_SIZE / 255 + 16));
+    check = (uint8_t*)malloc(size);
+    table = (long*)malloc(sizeof(long) << HASH_BITS);
+
+    if (!out || !check || !table) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (size_t slot = 0; slot < (1 << HASH_BITS); slot++) {
+        table[slot] = -1;
+    }
+
+    memcpy(out, "qoiz", 4);
+    write_be32(&out[4], size);
+    memcpy(&out[8], data, 14);
+
+    for (size_t start = 0; start < size; start += QOI_LZ_BLOCK_SIZE) {
+        size_t end = start + QOI_LZ_BLOCK_SIZE < size ? start + QOI_LZ_BLOCK_SIZE : size;
+        uint8_t* block = &out[packed_size];
+        size_t block_size = compress_block(data, start, end, table, block + QOI_LZ_BLOCK_HEADER_SIZE);
+
+        if (block_size >= end - start) {
+            block_size = end - start;
+            memcpy(block + QOI_LZ_BLOCK_HEADER_SIZE, &data[start], block_size);
+        }
+
+        write_be32(&block[0], block_size);
+        write_be32(&block[4], end - start);
+
+        packed_size += QOI_LZ_BLOCK_HEADER_SIZE + block_size;
+    }
+
+    // decompress everything again with the code the ROM uses
+    for (size_t pos = QOI_LZ_HEADER_SIZE, done = 0; done < size;) {
+        uint32_t block_packed_size, block_size;
+
+        if (!qoi_lz_read_block_header(&out[pos], &block_packed_size, &block_size) ||
+            !qoi_lz_decompress_block(&out[pos + QOI_LZ_BLOCK_HEADER_SIZE], block_packed_size, &check[done], block_size, check)
+        ) {
+            fprintf(stderr, "%s did not decompress\n", argv[2]);
+            return 1;
+        }
+
+        pos += QOI_LZ_BLOCK_HEADER_SIZE + block_packed_size;
+        done += block_size;
+    }
+
+    if (memcmp(check, data, size) != 0) {
+        fprintf(stderr, "%s did not decompress back to the same file\n", argv[2]);
+        return 1;
+    }
+
+    fp = fopen(argv[2], "wb");
+
+    if (!fp || fwrite(out, 1, packed_size, fp) != packed_size) {
+        fprintf(stderr, "Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    fclose(fp);
+
+    printf("%s: %zu -> %zu bytes (%.1f%%)\n", argv[1], size, packed_size, 100.0 * packed_size / size);
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+/*
+
+    qoi_plus.c
+
+    This file is a host tool that converts QOI files into QOI-plus files
+    for the N64 QOI Viewer ROM
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+
+
+/// @file qoi_plus.c
+/// @brief Host tool that converts QOI files into QOI-plus files
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIMPLIFIED_QOI_IMPLEMENTATION
+#include "sQOI.h"
+
+/// @brief Reads a whole file into memory
+/// @param filename Name of the file
+/// @param size Size of the file in bytes
+/// @return Contents of the file or NULL if it cannot be read
+static uint8_t* read_file(const char* filename, size_t* size) {
+    FILE* fp = fopen(filename, "rb");
+    uint8_t* bytes;
+
+    if (!fp) {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    bytes = (uint8_t*)malloc(*size);
+
+    if (bytes && fread(bytes, 1, *size, fp) != *size) {
+        free(bytes);
+        bytes = NULL;
+    }
+
+    fclose(fp);
+    return bytes;
+}
+
+/// @brief Encodes one filtered row and returns how many bytes it took
+/// @param desc QOI descriptor of the image
+/// @param enc Encoder state to continue from. It is left after the row
+/// @param row Filtered row of pixels
+/// @return Bytes written for the row
+static size_t encode_row(qoi_desc_t* desc, qoi_enc_t* enc, uint32_t* row) {
+    uint8_t* start = enc->offset;
+
+    for (uint32_t x = 0; x < desc->width; x++) {
+        qoi_encode_chunk(desc, enc, &row[x]);
+    }
+
+    return enc->offset - start;
+}
+
+/// @brief Encodes an image as a QOI-plus file picking the smaller filter for each row
+/// @param desc QOI descriptor of the image
+/// @param pixels RGBA32 pixels of the image
+/// @param out Memory for the QOI-plus file
+/// @param trial Memory as large as out to try the other filter in
+/// @return Size of the QOI-plus file in bytes
+static size_t encode_qoi_plus(qoi_desc_t* desc, uint32_t* pixels, uint8_t* out, uint8_t* trial) {
+    uint8_t* filters = out + 14;
+    uint32_t* filtered = (uint32_t*)malloc(desc->width * sizeof(uint32_t));
+    qoi_enc_t enc;
+
+    write_qoi_plus_header(desc, out);
+    qoi_enc_init(desc, &enc, out);
+    enc.offset = out + qoi_plus_header_size(desc);
+
+    for (uint32_t y = 0; y < desc->height; y++) {
+        uint32_t* row = &pixels[y * desc->width];
+        uint32_t* above = y > 0 ? row - desc->width : NULL;
+
+        // the encoder state is copied so both filters start from the same running array
+        qoi_enc_t plain = enc;
+        qoi_enc_t up = enc;
+        size_t plain_size, up_size;
+
+        qoi_filter_row(filtered, row, NULL, desc->width, QOI_FILTER_NONE);
+        plain_size = encode_row(desc, &plain, filtered);
+
+        up.offset = trial + (enc.offset - out);
+        qoi_filter_row(filtered, row, above, desc->width, QOI_FILTER_UP);
+        up_size = encode_row(desc, &up, filtered);
+
+        if (above && up_size < plain_size) {
+            memcpy(enc.offset, up.offset - up_size, up_size);
+            up.offset = enc.offset + up_size;
+            enc = up;
+            filters[y] = QOI_FILTER_UP;
+        }
+        else {
+            enc = plain;
+            filters[y] = QOI_FILTER_NONE;
+        }
+    }
+
+    free(filtered);
+    return enc.offset - out;
+}
+
+/// @brief Decodes a QOI-plus file to check it matches the source image
+/// @param desc QOI descriptor of the image
+/// @param pixels RGBA32 pixels of the source image
+/// @param bytes QOI-plus file
+/// @param size Size of the QOI-plus file in bytes
+/// @return true if every pixel matches
+static bool verify_qoi_plus(qoi_desc_t* desc, uint32_t* pixels, uint8_t* bytes, size_t size) {
+    size_t area = (size_t)desc->width * desc->height;
+    uint32_t* decoded = (uint32_t*)malloc(area * sizeof(uint32_t));
+    qoi_desc_t plus_desc;
+    qoi_dec_t dec;
+    bool match;
+
+    qoi_desc_init(&plus_desc);
+
+    if (!decoded || !read_qoi_plus_header(&plus_desc, bytes)) {
+        free(decoded);
+        return false;
+    }
+
+    qoi_dec_init(&plus_desc, &dec, bytes, size);
+    dec.offset = bytes + qoi_plus_header_size(&plus_desc);
+
+    for (uint32_t y = 0; y < plus_desc.height; y++) {
+        uint32_t* row = &decoded[y * plus_desc.width];
+
+        qoi_decode_span(&dec, row, plus_desc.width);
+        qoi_unfilter_row(row, y > 0 ? row - plus_desc.width : NULL, plus_desc.width, bytes[14 + y]);
+    }
+
+    match = memcmp(decoded, pixels, area * sizeof(uint32_t)) == 0;
+
+    free(decoded);
+    return match;
+}
+
+int main(int argc, char** argv) {
+    qoi_desc_t desc;
+    qoi_dec_t dec;
+    size_t qoi_size, plus_size, area;
+    uint8_t* qoi_bytes;
+    uint32_t* pixels;
+    uint8_t *out, *trial;
+    FILE* fp;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s input.qoi output.qoip\n", argv[0]);
+        return 1;
+    }
+
+    qoi_bytes = read_file(argv[1], &qoi_size);
+    qoi_desc_init(&desc);
+
+    if (!qoi_bytes || qoi_size < 14 || !read_qoi_header(&desc, qoi_bytes)) {
+        fprintf(stderr, "%s is not a QOI file\n", argv[1]);
+        return 1;
+    }
+
+    area = (size_t)desc.width * desc.height;
+    pixels = (uint32_t*)malloc(area * sizeof(uint32_t));
+
+    // the worst case is an RGBA chunk for every pixel
+    out = (uint8_t*)malloc(qoi_plus_header_size(&desc) + area * 5 + 8);
+    trial = (uint8_t*)malloc(qoi_plus_header_size(&desc) + area * 5 + 8);
+
+    if (!pixels || !out || !trial) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    qoi_dec_init(&desc, &dec, qoi_bytes, qoi_size);
+
+    if (qoi_decode_span(&dec, pixels, area) != area) {
+        fprintf(stderr, "%s is truncated\n", argv[1]);
+        return 1;
+    }
+
+    // 3 channel images get an alpha of 255 from the decoder so the filters see the same pixels as the viewer
+    plus_size = encode_qoi_plus(&desc, pixels, out, trial);
+
+    if (!verify_qoi_plus(&desc, pixels, out, plus_size)) {
+        fprintf(stderr, "%s did not decode back to the same image\n", argv[2]);
+        return 1;
+    }
+
+    fp = fopen(argv[2], "wb");
+
+    if (!fp || fwrite(out, 1, plus_size, fp) != plus_size) {
+        fprintf(stderr, "Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    fclose(fp);
+
+    printf("%s: %zu -> %zu bytes (%.1f%%)\n", argv[1], qoi_size, plus_size, 100.0 * plus_size / qoi_size);
+
+    return 0;
+}
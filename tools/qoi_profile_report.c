@@ -0,0 +1,198 @@
+/*
+
+    qoi_profile_report.c
+
+    This file is a host tool that sums up the decoder profile the N64 QOI Viewer
+    ROM prints over the debug log
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+
+
+/// @file qoi_profile_report.c
+/// @brief Host tool that sums up the decoder profile the viewer prints over the debug log
+/// @details The viewer prints the profile when it is built with QOI_DEC_PROFILE_DECODER set to 1 in config.h.
+/// Each image gets a table of how many chunks of each kind it had and the CPU cycles they took,
+/// followed by a table for all images together
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIMPLIFIED_QOI_IMPLEMENTATION
+#include "sQOI.h"
+
+/// @brief Most images in one report
+#define MAX_IMAGES 256
+
+/// @brief CPU cycles per tick of the COP0 Count register
+#define CYCLES_PER_TICK 2
+
+/// @brief Names of the kinds of work in the debug log. See enum qoi_profile_op in sQOI.h
+static const char* op_names[QOI_PROFILE_OPS] = {"rgb", "rgba", "index", "diff", "luma", "run", "hash", "fill", "store"};
+
+/// @brief Profile of one image summed over every time it was decoded
+typedef struct image_profile {
+    /// @brief Name of the image
+    char name[256];
+
+    /// @brief Chunks of each kind
+    double chunks[QOI_PROFILE_OPS];
+
+    /// @brief CPU cycles of each kind with the cost of counting taken out
+    double cycles[QOI_PROFILE_OPS];
+
+    /// @brief CPU cycles counting one chunk takes
+    double overhead;
+} image_profile_t;
+
+/// @brief Images in the report in the order they first appear in the log
+static image_profile_t images[MAX_IMAGES];
+
+/// @brief Number of images in the report
+static int num_images = 0;
+
+/// @brief Finds the profile of an image, adding it if it is new
+/// @param name Name of the image
+/// @return Profile of the image or NULL if there are too many images
+static image_profile_t* find_image(const char* name) {
+    for (int i = 0; i < num_images; i++) {
+        if (strcmp(images[i].name, name) == 0) {
+            return &images[i];
+        }
+    }
+
+    if (num_images >= MAX_IMAGES) {
+        return NULL;
+    }
+
+    snprintf(images[num_images].name, sizeof(images[num_images].name), "%s", name);
+
+    return &images[num_images++];
+}
+
+/// @brief Reads the profile lines of a debug log
+/// @param fp Debug log
+static void read_log(FILE* fp) {
+    char line[512];
+
+    while (fgets(line, sizeof(line), fp)) {
+        // the debug log may put something in front of each line
+        char* start = strstr(line, "qoi_profile ");
+        char op[16], name[256];
+        unsigned long chunks, ticks;
+        image_profile_t* image;
+
+        if (!start || sscanf(start, "qoi_profile %15s %lu %lu %255[^\r\n]", op, &chunks, &ticks, name) != 4) {
+            continue;
+        }
+
+        if (!(image = find_image(name))) {
+            continue;
+        }
+
+        // the overhead line comes first so the chunks after it can have it taken out
+        if (strcmp(op, "overhead") == 0) {
+            image->overhead = chunks > 0 ? (double)ticks * CYCLES_PER_TICK / chunks : 0.0;
+            continue;
+        }
+
+        for (int i = 0; i < QOI_PROFILE_OPS; i++) {
+            if (strcmp(op, op_names[i]) == 0) {
+                double cycles = (double)ticks * CYCLES_PER_TICK - image->overhead * chunks;
+
+                image->chunks[i] += chunks;
+                image->cycles[i] += cycles > 0.0 ? cycles : 0.0;
+            }
+        }
+    }
+}
+
+/// @brief Prints the table of one profile
+/// @param image Profile to print
+static void print_profile(const image_profile_t* image) {
+    double total = 0.0;
+
+    for (int i = 0; i < QOI_PROFILE_OPS; i++) {
+        total += image->cycles[i];
+    }
+
+    printf("%s\n", image->name);
+    printf("  %-6s %12s %14s %10s %7s\n", "kind", "count", "cycles", "per chunk", "share");
+
+    for (int i = 0; i < QOI_PROFILE_OPS; i++) {
+        printf(
+            "  %-6s %12.0f %14.0f %10.1f %6.1f%%\n",
+            op_names[i],
+            image->chunks[i],
+            image->cycles[i],
+            image->chunks[i] > 0.0 ? image->cycles[i] / image->chunks[i] : 0.0,
+            total > 0.0 ? image->cycles[i] * 100.0 / total : 0.0
+        );
+    }
+
+    printf("  %-6s %12s %14.0f\n\n", "total", "", total);
+}
+
+int main(int argc, char** argv) {
+    image_profile_t all;
+
+    if (argc < 2) {
+        read_log(stdin);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        FILE* fp = fopen(argv[i], "r");
+
+        if (!fp) {
+            fprintf(stderr, "Cannot read %s\n", argv[i]);
+            return 1;
+        }
+
+        read_log(fp);
+        fclose(fp);
+    }
+
+    if (num_images == 0) {
+        fprintf(stderr, "No profile in the log. Build the viewer with QOI_DEC_PROFILE_DECODER set to 1\n");
+        return 1;
+    }
+
+    memset(&all, 0, sizeof(all));
+    snprintf(all.name, sizeof(all.name), "all %d images", num_images);
+
+    for (int i = 0; i < num_images; i++) {
+        print_profile(&images[i]);
+
+        for (int op = 0; op < QOI_PROFILE_OPS; op++) {
+            all.chunks[op] += images[i].chunks[op];
+            all.cycles[op] += images[i].cycles[op];
+        }
+    }
+
+    print_profile(&all);
+
+    return 0;
+}
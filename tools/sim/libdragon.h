@@ -0,0 +1,400 @@
+/*
+
+    libdragon.h
+
+    This header stands in for the parts of libdragon the N64 QOI Viewer uses
+    so the viewer can run headless on a computer
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+/// @file libdragon.h
+/// @brief Stand-in for the parts of libdragon the N64 QOI Viewer uses
+/// @details Only the functions, types and macros the viewer calls are here, with the same names as libdragon.
+/// Drawing happens on the CPU into the framebuffer, the timer runs on a virtual clock that skips ahead to
+/// each vertical blank, files come from a directory on the computer and input comes from a script
+
+#ifndef QOI_SIM_LIBDRAGON_H
+#define QOI_SIM_LIBDRAGON_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Debugging */
+
+/// @brief Prints to the debug log, which is stderr
+#define debugf(...) fprintf(stderr, __VA_ARGS__)
+
+/// @brief Stops the program with a message if a condition is false
+#define assertf(cond, ...) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "ASSERTION FAILED: %s (%s:%d)\n", #cond, __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            abort(); \
+        } \
+    } while (0)
+
+bool debug_init_usblog(void);
+void console_init(void);
+void console_close(void);
+void console_clear(void);
+void console_set_debug(bool debug);
+
+/* System */
+
+/// @brief Sets memory with the RSP on the N64 and with memset here
+#define sys_hw_memset(ptr, value, len) memset((ptr), (value), (len))
+
+/// @brief Gets the RDRAM installed in bytes, set with -m
+int get_memory_size(void);
+
+void data_cache_hit_writeback(volatile const void* addr, unsigned long length);
+void data_cache_hit_invalidate(volatile void* addr, unsigned long length);
+void data_cache_hit_writeback_invalidate(volatile void* addr, unsigned long length);
+
+/* Timer */
+
+/// @brief Timer ticks per second of the N64 CPU counter
+#define TICKS_PER_SECOND (93750000 / 2)
+
+#define TICKS_TO_US(val) (((val) * 8) / 375)
+#define TICKS_TO_MS(val) ((val) / (TICKS_PER_SECOND / 1000))
+#define TICKS_FROM_US(val) (((val) * 375) / 8)
+#define TICKS_FROM_MS(val) ((val) * (TICKS_PER_SECOND / 1000))
+
+void timer_init(void);
+long long timer_ticks(void);
+void wait_ms(unsigned long ms);
+
+/// @brief COP0 Count register, read from the host clock at the same rate
+#define C0_COUNT() ((uint32_t)timer_ticks())
+
+/* Filesystem */
+
+/// @brief Longest file name the filesystem holds
+#define MAX_FILENAME_LEN 243
+
+/// @brief Place of the filesystem in ROM, unused here
+#define DFS_DEFAULT_LOCATION 0
+
+/// @brief No error
+#define DFS_ESUCCESS 0
+
+/// @brief Directory entry is a file
+#define FLAGS_FILE 1
+
+/// @brief Directory entry is a directory
+#define FLAGS_DIR 2
+
+int dfs_init(uint32_t base_fs_loc);
+int dfs_dir_findfirst(const char* path, char* buf);
+int dfs_dir_findnext(char* buf);
+
+/// @brief Gets the cartridge address of a file. The files are laid out one after another in a made up ROM
+uint32_t dfs_rom_addr(const char* path);
+
+/// @brief Opens rom:/ paths from the directory the simulator was started with
+FILE* sim_fopen(const char* filename, const char* mode);
+
+#define fopen(filename, mode) sim_fopen((filename), (mode))
+
+/* PI DMA */
+
+/// @brief Starts copying from the made up ROM on a thread. Takes the time the PI would to finish
+void dma_read_raw_async(void* ram_address, unsigned long pi_address, unsigned long len);
+void dma_wait(void);
+int dma_busy(void);
+
+/* Controller */
+
+typedef enum {
+    JOYPAD_PORT_1,
+    JOYPAD_PORT_2,
+    JOYPAD_PORT_3,
+    JOYPAD_PORT_4
+} joypad_port_t;
+
+typedef enum {
+    JOYPAD_AXIS_STICK_X,
+    JOYPAD_AXIS_STICK_Y
+} joypad_axis_t;
+
+typedef struct {
+    unsigned a : 1;
+    unsigned b : 1;
+    unsigned z : 1;
+    unsigned start : 1;
+    unsigned d_up : 1;
+    unsigned d_down : 1;
+    unsigned d_left : 1;
+    unsigned d_right : 1;
+    unsigned l : 1;
+    unsigned r : 1;
+    unsigned c_up : 1;
+    unsigned c_down : 1;
+    unsigned c_left : 1;
+    unsigned c_right : 1;
+} joypad_buttons_t;
+
+typedef struct {
+    joypad_buttons_t btn;
+    int8_t stick_x;
+    int8_t stick_y;
+} joypad_inputs_t;
+
+void joypad_init(void);
+void joypad_poll(void);
+joypad_inputs_t joypad_get_inputs(joypad_port_t port);
+joypad_buttons_t joypad_get_buttons_pressed(joypad_port_t port);
+int joypad_get_axis_pressed(joypad_port_t port, joypad_axis_t axis);
+
+/* Colors and surfaces */
+
+typedef struct {
+    uint8_t r, g, b, a;
+} color_t;
+
+#define RGBA32(rx, gx, bx, ax) ((color_t){.r = (rx), .g = (gx), .b = (bx), .a = (ax)})
+#define RGBA16(rx, gx, bx, ax) ((color_t){.r = (rx) << 3, .g = (gx) << 3, .b = (bx) << 3, .a = (ax) ? 0xFF : 0})
+
+uint16_t color_to_packed16(color_t c);
+
+typedef enum {
+    FMT_NONE,
+    FMT_RGBA16,
+    FMT_RGBA32,
+    FMT_CI4,
+    FMT_CI8,
+    FMT_I4,
+    FMT_I8,
+    FMT_IA4,
+    FMT_IA8,
+    FMT_IA16
+} tex_format_t;
+
+/// @brief Bits per pixel of a texture format
+int tex_format_bitdepth(tex_format_t fmt);
+
+#define TEX_FORMAT_BITDEPTH(fmt) tex_format_bitdepth(fmt)
+#define TEX_FORMAT_PIX2BYTES(fmt, pixels) (((pixels) * TEX_FORMAT_BITDEPTH(fmt)) >> 3)
+
+typedef struct surface_s {
+    uint16_t flags;
+    uint16_t width;
+    uint16_t height;
+    uint16_t stride;
+    void* buffer;
+} surface_t;
+
+surface_t surface_make(void* buffer, tex_format_t format, uint16_t width, uint16_t height, uint16_t stride);
+surface_t surface_make_linear(void* buffer, tex_format_t format, uint16_t width, uint16_t height);
+tex_format_t surface_get_format(const surface_t* surface);
+
+/* Display */
+
+typedef struct {
+    int32_t width;
+    int32_t height;
+} resolution_t;
+
+#define RESOLUTION_320x240 ((resolution_t){.width = 320, .height = 240})
+
+typedef enum {
+    DEPTH_16_BPP,
+    DEPTH_32_BPP
+} bitdepth_t;
+
+typedef enum {
+    GAMMA_NONE,
+    GAMMA_CORRECT,
+    GAMMA_CORRECT_DITHER
+} gamma_t;
+
+typedef enum {
+    FILTERS_DISABLED,
+    FILTERS_RESAMPLE,
+    FILTERS_DEDITHER,
+    FILTERS_RESAMPLE_ANTIALIAS,
+    FILTERS_RESAMPLE_ANTIALIAS_DEDITHER
+} filter_options_t;
+
+void display_init(resolution_t res, bitdepth_t bit, uint32_t num_buffers, gamma_t gamma, filter_options_t filters);
+surface_t* display_get(void);
+surface_t* display_try_get(void);
+float display_get_refresh_rate(void);
+
+/* RDP */
+
+typedef enum {
+    TILE0,
+    TILE1,
+    TILE2,
+    TILE3,
+    TILE4,
+    TILE5,
+    TILE6,
+    TILE7
+} rdpq_tile_t;
+
+typedef enum {
+    FILTER_POINT,
+    FILTER_BILINEAR,
+    FILTER_MEDIAN
+} rdpq_filter_t;
+
+typedef enum {
+    TLUT_NONE,
+    TLUT_RGBA16,
+    TLUT_IA16
+} rdpq_tlut_t;
+
+/// @brief Texture coordinates repeat forever
+#define REPEAT_INFINITE 2048
+
+typedef struct {
+    int tmem_addr;
+    int palette;
+    struct {
+        float translate;
+        int scale_log;
+        float repeats;
+        bool mirror;
+    } s, t;
+} rdpq_texparms_t;
+
+typedef struct {
+    int s0;
+    int t0;
+    int width;
+    int height;
+    bool flip_x;
+    bool flip_y;
+    int cx;
+    int cy;
+    float scale_x;
+    float scale_y;
+    float theta;
+    bool filtering;
+    int nx;
+    int ny;
+} rdpq_blitparms_t;
+
+typedef uint64_t rdpq_combiner_t;
+typedef uint32_t rdpq_blender_t;
+
+/// @brief Combiner id for a one-cycle combiner written as ((A,B,C,D), (A,B,C,D)) for (A - B) * C + D
+/// @details The inputs are parsed when the id is made. TEX0, PRIM, ENV, 0 and 1 are understood,
+/// as well as TEX0_ALPHA, PRIM_ALPHA and ENV_ALPHA in the color inputs
+rdpq_combiner_t sim_combiner(const char* rgb, const char* alpha);
+
+#define RDPQ_COMBINER1(rgb, alpha) sim_combiner(#rgb, #alpha)
+
+/// @brief Combiner that outputs the texture as it is
+#define RDPQ_COMBINER_TEX RDPQ_COMBINER1((0,0,0,TEX0), (0,0,0,TEX0))
+
+/// @brief Blender writing the pixel as it is
+#define RDPQ_BLENDER_NONE 0
+
+/// @brief Blender mixing the pixel with the framebuffer by its alpha
+#define RDPQ_BLENDER_MULTIPLY 1
+
+/// @brief Blender adding the pixel times its alpha to the framebuffer
+#define RDPQ_BLENDER_ADDITIVE 2
+
+void rdpq_init(void);
+void rdpq_attach(const surface_t* surf_color, const surface_t* surf_z);
+void rdpq_detach_show(void);
+void rdpq_set_mode_fill(color_t color);
+void rdpq_set_mode_standard(void);
+void rdpq_mode_combiner(rdpq_combiner_t comb);
+void rdpq_mode_blender(rdpq_blender_t blend);
+void rdpq_mode_filter(rdpq_filter_t filt);
+void rdpq_mode_tlut(rdpq_tlut_t tlut);
+void rdpq_set_prim_color(color_t color);
+void rdpq_set_scissor(int x0, int y0, int x1, int y1);
+void rdpq_fill_rectangle(float x0, float y0, float x1, float y1);
+int rdpq_tex_upload(rdpq_tile_t tile, const surface_t* tex, const rdpq_texparms_t* parms);
+void rdpq_tex_upload_tlut(uint16_t* tlut, int color_idx, int num_colors);
+void rdpq_tex_blit(const surface_t* surf, float x0, float y0, const rdpq_blitparms_t* parms);
+void rdpq_texture_rectangle_scaled(rdpq_tile_t tile, float x0, float y0, float x1, float y1, float s0, float t0, float s1, float t1);
+
+/* Display lists */
+
+typedef struct rspq_block_s rspq_block_t;
+
+void rspq_block_begin(void);
+rspq_block_t* rspq_block_end(void);
+void rspq_block_run(rspq_block_t* block);
+void rspq_block_free(rspq_block_t* block);
+
+/// @brief Point in the command queue the CPU can wait for
+typedef int rspq_syncpoint_t;
+
+rspq_syncpoint_t rspq_syncpoint_new(void);
+void rspq_syncpoint_wait(rspq_syncpoint_t sync_id);
+
+/* Text */
+
+typedef struct rdpq_font_s rdpq_font_t;
+
+/// @brief Font built into libdragon
+#define FONT_BUILTIN_DEBUG_MONO 1
+
+typedef enum {
+    ALIGN_LEFT,
+    ALIGN_CENTER,
+    ALIGN_RIGHT
+} rdpq_align_t;
+
+typedef enum {
+    WRAP_NONE,
+    WRAP_ELLIPSES,
+    WRAP_CHAR,
+    WRAP_WORD
+} rdpq_textwrap_t;
+
+typedef struct {
+    int16_t width;
+    int16_t height;
+    rdpq_align_t align;
+    rdpq_textwrap_t wrap;
+} rdpq_textparms_t;
+
+rdpq_font_t* rdpq_font_load_builtin(int font);
+void rdpq_text_register_font(uint8_t font_id, const rdpq_font_t* font);
+int rdpq_text_printf(const rdpq_textparms_t* parms, uint8_t font_id, float x0, float y0, const char* fmt, ...);
+
+#if __cplusplus
+}
+#endif
+
+#endif // QOI_SIM_LIBDRAGON_H
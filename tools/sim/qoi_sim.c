@@ -0,0 +1,1324 @@
+/*
+
+    qoi_sim.c
+
+    This file is a host tool that runs the N64 QOI Viewer headless on a computer
+    with a stand-in for libdragon
+
+    Code licensed under MIT License
+
+    Copyright (c) 2026 Aftersol
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+*/
+
+
+/// @file qoi_sim.c
+/// @brief Host tool that runs the N64 QOI Viewer headless on a computer
+/// @details The viewer is built with main renamed to viewer_main and runs unchanged on top of
+/// the stand-in for libdragon in this file. Every frame it draws is timed and can be written out as a PPM image
+
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "libdragon.h"
+
+// the viewer is built with -Dmain=viewer_main so this file has to take the name back
+#undef main
+
+/// @brief Entry point of the viewer in main.c
+int viewer_main(void);
+
+/// @brief Most events an input script can hold
+#define MAX_EVENTS 1024
+
+/// @brief Most files the filesystem directory can hold
+#define MAX_FILES 1024
+
+/// @brief Most combiners the viewer can make
+#define MAX_COMBINERS 32
+
+/// @brief Width and height of the framebuffer
+#define FB_WIDTH 320
+#define FB_HEIGHT 240
+
+/// @brief Cartridge address the made up ROM filesystem starts at, 1 MiB into the cartridge like DFS_DEFAULT_LOCATION
+#define ROM_FS_START 0x10101000
+
+/// @brief Bytes per second the PI moves from the cartridge to RDRAM
+#define PI_BYTES_PER_SECOND 5000000
+
+/// @brief Buttons an input script can press
+typedef enum sim_button {
+    SIM_A, SIM_B, SIM_Z, SIM_START,
+    SIM_D_UP, SIM_D_DOWN, SIM_D_LEFT, SIM_D_RIGHT,
+    SIM_L, SIM_R,
+    SIM_C_UP, SIM_C_DOWN, SIM_C_LEFT, SIM_C_RIGHT,
+    SIM_STICK_LEFT, SIM_STICK_RIGHT,
+    /// @brief Not a button. Writes the frame to the dump directory
+    SIM_DUMP,
+    SIM_BUTTONS
+} sim_button_t;
+
+/// @brief Names of the buttons in input scripts
+static const char* button_names[SIM_BUTTONS] = {
+    "a", "b", "z", "start",
+    "d_up", "d_down", "d_left", "d_right",
+    "l", "r",
+    "c_up", "c_down", "c_left", "c_right",
+    "stick_left", "stick_right",
+    "dump"
+};
+
+/// @brief A line of an input script
+typedef struct sim_event {
+    /// @brief Frame the button goes down on
+    int frame;
+
+    /// @brief Button pressed
+    sim_button_t button;
+
+    /// @brief Number of frames the button is held for
+    int frames;
+} sim_event_t;
+
+/// @brief Inputs of the combiner
+typedef enum sim_input {
+    IN_ZERO,
+    IN_ONE,
+    IN_TEX0,
+    IN_PRIM,
+    IN_ENV,
+    IN_TEX0_ALPHA,
+    IN_PRIM_ALPHA,
+    IN_ENV_ALPHA
+} sim_input_t;
+
+/// @brief A combiner computing (A - B) * C + D for the color and the alpha
+typedef struct sim_combiner {
+    /// @brief Text of the color inputs as written in the source
+    char rgbText[64];
+
+    /// @brief Text of the alpha inputs as written in the source
+    char alphaText[64];
+
+    /// @brief Color inputs A, B, C and D
+    sim_input_t rgb[4];
+
+    /// @brief Alpha inputs A, B, C and D
+    sim_input_t alpha[4];
+} sim_combiner_t;
+
+/// @brief Everything the simulator keeps between calls from the viewer
+static struct {
+    /// @brief Directory rom:/ paths are opened from
+    const char* fsDir;
+
+    /// @brief Directory frames are written to or NULL
+    const char* dumpDir;
+
+    /// @brief Write every nth frame to the dump directory. 0 writes only the last frame
+    int dumpEvery;
+
+    /// @brief Frames to run before exiting
+    int maxFrames;
+
+    /// @brief RDRAM reported to the viewer in bytes
+    int memorySize;
+
+    /// @brief CSV file of the time each frame took or NULL
+    FILE* timing;
+
+    /// @brief Input script
+    sim_event_t events[MAX_EVENTS];
+
+    /// @brief Number of events in the input script
+    int numEvents;
+
+    /// @brief Files in the filesystem directory sorted by name
+    char* files[MAX_FILES];
+
+    /// @brief Number of files in the filesystem directory
+    int numFiles;
+
+    /// @brief Next file dfs_dir_findnext() returns
+    int nextFile;
+
+    /// @brief Cartridge address of each file in the made up ROM
+    uint32_t fileAddresses[MAX_FILES];
+
+    /// @brief Size of each file in bytes
+    uint32_t fileSizes[MAX_FILES];
+
+    /// @brief Thread copying the transfer in flight
+    pthread_t dmaThread;
+
+    /// @brief Whether a transfer was started and not waited for
+    bool dmaStarted;
+
+    /// @brief Set by the thread once the bytes of the transfer are copied
+    int dmaCopied;
+
+    /// @brief Ticks when the PI would be done with the transfer
+    long long dmaDoneAt;
+
+    /// @brief RDRAM address of the transfer
+    void* dmaRam;
+
+    /// @brief Cartridge address of the transfer
+    uint32_t dmaRom;
+
+    /// @brief Size of the transfer in bytes
+    uint32_t dmaSize;
+
+    /// @brief Ticks added to the host clock so waiting for the vertical blank takes no time
+    long long clockOffset;
+
+    /// @brief Ticks of the next vertical blank
+    long long nextVblank;
+
+    /// @brief Ticks when the current frame started
+    long long frameStart;
+
+    /// @brief Ticks between vertical blanks
+    long long frameTicks;
+
+    /// @brief Frames handed out by display_try_get() so far
+    int frame;
+
+    /// @brief Ticks of CPU time spent in all frames
+    long long totalTicks;
+
+    /// @brief Ticks of CPU time spent in the slowest frame
+    long long worstTicks;
+
+    /// @brief Frames that took longer than a refresh
+    int slowFrames;
+
+    /// @brief Buttons held this frame, one bit per sim_button_t
+    uint32_t held;
+
+    /// @brief Buttons held last frame
+    uint32_t heldBefore;
+
+    /// @brief The framebuffer
+    uint32_t pixels[FB_WIDTH * FB_HEIGHT];
+
+    /// @brief Surface of the framebuffer
+    surface_t display;
+
+    /// @brief Surface being drawn to
+    const surface_t* target;
+
+    /// @brief Whether the fill mode is set instead of the standard mode
+    bool fillMode;
+
+    /// @brief Color of the fill mode
+    color_t fillColor;
+
+    /// @brief Combiner id set or 0 to output the texture
+    rdpq_combiner_t combiner;
+
+    /// @brief Blender set
+    rdpq_blender_t blender;
+
+    /// @brief Texture filter set
+    rdpq_filter_t filter;
+
+    /// @brief Palette mode set
+    rdpq_tlut_t tlutMode;
+
+    /// @brief Primitive color
+    color_t prim;
+
+    /// @brief Palette loaded into TMEM
+    uint16_t tlut[256];
+
+    /// @brief Texture loaded into TILE0
+    surface_t tile;
+
+    /// @brief Whether the texture in TILE0 repeats
+    bool tileRepeats;
+
+    /// @brief Scissor rectangle
+    int scissor[4];
+
+    /// @brief Combiners made by sim_combiner()
+    sim_combiner_t combiners[MAX_COMBINERS];
+
+    /// @brief Number of combiners made
+    int numCombiners;
+} sim;
+
+/// @brief Reads the host clock
+/// @return Host time in timer ticks
+static long long host_ticks(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * TICKS_PER_SECOND + (long long)ts.tv_nsec * (TICKS_PER_SECOND / 1000000) / 1000;
+}
+
+/* Debugging */
+
+bool debug_init_usblog(void) {
+    return true;
+}
+
+void console_init(void) {}
+
+void console_close(void) {}
+
+void console_clear(void) {}
+
+void console_set_debug(bool debug) {
+    (void)debug;
+}
+
+/* System */
+
+int get_memory_size(void) {
+    return sim.memorySize;
+}
+
+void data_cache_hit_writeback(volatile const void* addr, unsigned long length) {
+    (void)addr;
+    (void)length;
+}
+
+void data_cache_hit_invalidate(volatile void* addr, unsigned long length) {
+    (void)addr;
+    (void)length;
+}
+
+void data_cache_hit_writeback_invalidate(volatile void* addr, unsigned long length) {
+    (void)addr;
+    (void)length;
+}
+
+/* Timer */
+
+void timer_init(void) {}
+
+long long timer_ticks(void) {
+    return host_ticks() + sim.clockOffset;
+}
+
+void wait_ms(unsigned long ms) {
+    // waiting takes no time on the computer
+    sim.clockOffset += TICKS_FROM_MS((long long)ms);
+}
+
+/* Filesystem */
+
+/// @brief Orders file names for qsort()
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+int dfs_init(uint32_t base_fs_loc) {
+    DIR* dir = opendir(sim.fsDir);
+    struct dirent* entry;
+
+    (void)base_fs_loc;
+
+    if (!dir) {
+        return -1;
+    }
+
+    // the ROM filesystem has no directories so only the files at the top are used
+    while ((entry = readdir(dir)) && sim.numFiles < MAX_FILES) {
+        char path[1024];
+        struct stat st;
+
+        if (entry->d_name[0] == '.' || strlen(entry->d_name) > MAX_FILENAME_LEN) {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", sim.fsDir, entry->d_name);
+
+        if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            sim.files[sim.numFiles++] = strdup(entry->d_name);
+        }
+    }
+
+    closedir(dir);
+
+    qsort(sim.files, sim.numFiles, sizeof(char*), compare_names);
+
+    // files are laid out one after another on 16 byte boundaries
+    for (int i = 0; i < sim.numFiles; i++) {
+        struct stat st;
+        char path[1024];
+
+        snprintf(path, sizeof(path), "%s/%s", sim.fsDir, sim.files[i]);
+        sim.fileSizes[i] = stat(path, &st) == 0 ? (uint32_t)st.st_size : 0;
+
+        sim.fileAddresses[i] = i > 0 ? (sim.fileAddresses[i - 1] + sim.fileSizes[i - 1] + 15) & ~15u : ROM_FS_START;
+    }
+
+    return DFS_ESUCCESS;
+}
+
+uint32_t dfs_rom_addr(const char* path) {
+    if (path[0] == '/') {
+        path++;
+    }
+
+    for (int i = 0; i < sim.numFiles; i++) {
+        if (strcmp(sim.files[i], path) == 0) {
+            return sim.fileAddresses[i];
+        }
+    }
+
+    return 0;
+}
+
+int dfs_dir_findfirst(const char* path, char* buf) {
+    (void)path;
+
+    sim.nextFile = 0;
+
+    return dfs_dir_findnext(buf);
+}
+
+int dfs_dir_findnext(char* buf) {
+    if (sim.nextFile >= sim.numFiles) {
+        return -1;
+    }
+
+    strcpy(buf, sim.files[sim.nextFile++]);
+
+    return FLAGS_FILE;
+}
+
+FILE* sim_fopen(const char* filename, const char* mode) {
+    char path[1024];
+
+    if (strncmp(filename, "rom:/", 5) != 0) {
+        return (fopen)(filename, mode);
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", sim.fsDir, filename + 5);
+
+    return (fopen)(path, mode);
+}
+
+/* PI DMA */
+
+/// @brief Copies the bytes of the transfer in flight from the file they are in
+/// @param arg Unused
+/// @return NULL
+static void* copy_transfer(void* arg) {
+    (void)arg;
+
+    for (int i = 0; i < sim.numFiles; i++) {
+        uint32_t offset = sim.dmaRom - sim.fileAddresses[i];
+        char path[1024];
+        FILE* fp;
+
+        if (sim.dmaRom < sim.fileAddresses[i] || offset >= sim.fileSizes[i]) {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", sim.fsDir, sim.files[i]);
+
+        // bytes past the end of the file are left as they were
+        if ((fp = (fopen)(path, "rb"))) {
+            fseek(fp, offset, SEEK_SET);
+
+            if (fread(sim.dmaRam, 1, sim.dmaSize, fp) == 0) {
+                fprintf(stderr, "PI DMA from %08x read nothing\n", sim.dmaRom);
+            }
+
+            fclose(fp);
+        }
+
+        break;
+    }
+
+    __atomic_store_n(&sim.dmaCopied, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+void dma_read_raw_async(void* ram_address, unsigned long pi_address, unsigned long len) {
+    // the PI takes one transfer at a time
+    dma_wait();
+
+    assertf(((uintptr_t)ram_address & 7) == 0 && (pi_address & 1) == 0, "PI DMA to %p from %08lx is not aligned", ram_address, pi_address);
+
+    sim.dmaRam = ram_address;
+    sim.dmaRom = (uint32_t)pi_address;
+    sim.dmaSize = (uint32_t)len;
+    sim.dmaCopied = 0;
+    sim.dmaDoneAt = timer_ticks() + (long long)len * TICKS_PER_SECOND / PI_BYTES_PER_SECOND;
+    sim.dmaStarted = true;
+
+    if (pthread_create(&sim.dmaThread, NULL, copy_transfer, NULL) != 0) {
+        copy_transfer(NULL);
+        sim.dmaStarted = false;
+    }
+}
+
+void dma_wait(void) {
+    long long now = timer_ticks();
+
+    if (sim.dmaStarted) {
+        pthread_join(sim.dmaThread, NULL);
+        sim.dmaStarted = false;
+    }
+
+    // the CPU sits idle until the PI would be done
+    if (now < sim.dmaDoneAt) {
+        sim.clockOffset += sim.dmaDoneAt - now;
+    }
+}
+
+int dma_busy(void) {
+    if (timer_ticks() < sim.dmaDoneAt || (sim.dmaStarted && !__atomic_load_n(&sim.dmaCopied, __ATOMIC_ACQUIRE))) {
+        return 1;
+    }
+
+    if (sim.dmaStarted) {
+        pthread_join(sim.dmaThread, NULL);
+        sim.dmaStarted = false;
+    }
+
+    return 0;
+}
+
+/* Controller */
+
+/// @brief Checks if a button is held this frame
+/// @param button Button to check
+/// @return 1 if the button is held
+static unsigned is_held(sim_button_t button) {
+    return (sim.held >> button) & 1;
+}
+
+/// @brief Turns a set of buttons into the controller structure
+/// @param mask Buttons, one bit per sim_button_t
+/// @return The buttons as libdragon reports them
+static joypad_buttons_t to_buttons(uint32_t mask) {
+    joypad_buttons_t buttons;
+
+    memset(&buttons, 0, sizeof(buttons));
+
+    buttons.a = (mask >> SIM_A) & 1;
+    buttons.b = (mask >> SIM_B) & 1;
+    buttons.z = (mask >> SIM_Z) & 1;
+    buttons.start = (mask >> SIM_START) & 1;
+    buttons.d_up = (mask >> SIM_D_UP) & 1;
+    buttons.d_down = (mask >> SIM_D_DOWN) & 1;
+    buttons.d_left = (mask >> SIM_D_LEFT) & 1;
+    buttons.d_right = (mask >> SIM_D_RIGHT) & 1;
+    buttons.l = (mask >> SIM_L) & 1;
+    buttons.r = (mask >> SIM_R) & 1;
+    buttons.c_up = (mask >> SIM_C_UP) & 1;
+    buttons.c_down = (mask >> SIM_C_DOWN) & 1;
+    buttons.c_left = (mask >> SIM_C_LEFT) & 1;
+    buttons.c_right = (mask >> SIM_C_RIGHT) & 1;
+
+    return buttons;
+}
+
+void joypad_init(void) {}
+
+void joypad_poll(void) {
+    sim.heldBefore = sim.held;
+    sim.held = 0;
+
+    for (int i = 0; i < sim.numEvents; i++) {
+        sim_event_t* event = &sim.events[i];
+
+        if (sim.frame >= event->frame && sim.frame < event->frame + event->frames) {
+            sim.held |= 1u << event->button;
+        }
+    }
+}
+
+joypad_inputs_t joypad_get_inputs(joypad_port_t port) {
+    joypad_inputs_t inputs;
+
+    memset(&inputs, 0, sizeof(inputs));
+
+    if (port == JOYPAD_PORT_1) {
+        inputs.btn = to_buttons(sim.held);
+        inputs.stick_x = is_held(SIM_STICK_LEFT) ? -80 : is_held(SIM_STICK_RIGHT) ? 80 : 0;
+    }
+
+    return inputs;
+}
+
+joypad_buttons_t joypad_get_buttons_pressed(joypad_port_t port) {
+    return to_buttons(port == JOYPAD_PORT_1 ? sim.held & ~sim.heldBefore : 0);
+}
+
+int joypad_get_axis_pressed(joypad_port_t port, joypad_axis_t axis) {
+    uint32_t pressed = sim.held & ~sim.heldBefore;
+
+    if (port != JOYPAD_PORT_1 || axis != JOYPAD_AXIS_STICK_X) {
+        return 0;
+    }
+
+    if ((pressed >> SIM_STICK_LEFT) & 1) {
+        return -1;
+    }
+
+    return (pressed >> SIM_STICK_RIGHT) & 1;
+}
+
+/* Colors and surfaces */
+
+uint16_t color_to_packed16(color_t c) {
+    return ((c.r >> 3) << 11) | ((c.g >> 3) << 6) | ((c.b >> 3) << 1) | (c.a >> 7);
+}
+
+/// @brief Turns a packed RGBA 5551 value into a color the way the RDP widens it
+/// @param value Packed color
+/// @return The color
+static color_t unpack16(uint16_t value) {
+    uint8_t r = (value >> 11) & 31;
+    uint8_t g = (value >> 6) & 31;
+    uint8_t b = (value >> 1) & 31;
+
+    return RGBA32((r << 3) | (r >> 2), (g << 3) | (g >> 2), (b << 3) | (b >> 2), (value & 1) ? 255 : 0);
+}
+
+int tex_format_bitdepth(tex_format_t fmt) {
+    switch (fmt) {
+        case FMT_RGBA32:
+            return 32;
+        case FMT_RGBA16:
+        case FMT_IA16:
+            return 16;
+        case FMT_CI8:
+        case FMT_I8:
+        case FMT_IA8:
+            return 8;
+        case FMT_CI4:
+        case FMT_I4:
+        case FMT_IA4:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+surface_t surface_make(void* buffer, tex_format_t format, uint16_t width, uint16_t height, uint16_t stride) {
+    return (surface_t){
+        .flags = format,
+        .width = width,
+        .height = height,
+        .stride = stride,
+        .buffer = buffer
+    };
+}
+
+surface_t surface_make_linear(void* buffer, tex_format_t format, uint16_t width, uint16_t height) {
+    return surface_make(buffer, format, width, height, TEX_FORMAT_PIX2BYTES(format, width));
+}
+
+tex_format_t surface_get_format(const surface_t* surface) {
+    return (tex_format_t)surface->flags;
+}
+
+/* Display */
+
+/// @brief Writes the framebuffer as a binary PPM image
+/// @param name Name of the image in the dump directory
+static void dump_frame(const char* name) {
+    char path[1024];
+    FILE* fp;
+
+    snprintf(path, sizeof(path), "%s/%s", sim.dumpDir, name);
+
+    if (!(fp = (fopen)(path, "wb"))) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return;
+    }
+
+    fprintf(fp, "P6\n%d %d\n255\n", FB_WIDTH, FB_HEIGHT);
+
+    for (int i = 0; i < FB_WIDTH * FB_HEIGHT; i++) {
+        fwrite(&sim.pixels[i], 1, 3, fp);
+    }
+
+    fclose(fp);
+}
+
+/// @brief Prints how long the frames took and exits
+static void finish(void) {
+    if (sim.dumpDir && sim.dumpEvery == 0) {
+        dump_frame("last.ppm");
+    }
+
+    if (sim.timing) {
+        fclose(sim.timing);
+    }
+
+    printf(
+        "%d frames, %lld us average, %lld us worst, %d frames longer than a refresh\n",
+        sim.frame,
+        TICKS_TO_US(sim.totalTicks / (sim.frame > 0 ? sim.frame : 1)),
+        TICKS_TO_US(sim.worstTicks),
+        sim.slowFrames
+    );
+
+    exit(0);
+}
+
+void display_init(resolution_t res, bitdepth_t bit, uint32_t num_buffers, gamma_t gamma, filter_options_t filters) {
+    (void)num_buffers;
+    (void)gamma;
+    (void)filters;
+
+    assertf(res.width == FB_WIDTH && res.height == FB_HEIGHT && bit == DEPTH_32_BPP, "Only 320x240 at 32 bits per pixel is simulated");
+
+    sim.display = surface_make_linear(sim.pixels, FMT_RGBA32, FB_WIDTH, FB_HEIGHT);
+    sim.frameTicks = (long long)(TICKS_PER_SECOND / display_get_refresh_rate());
+    sim.nextVblank = timer_ticks();
+}
+
+surface_t* display_try_get(void) {
+    long long now = timer_ticks();
+
+    if (sim.frame > 0) {
+        long long ticks = now - sim.frameStart;
+
+        sim.totalTicks += ticks;
+        sim.slowFrames += ticks > sim.frameTicks;
+
+        if (ticks > sim.worstTicks) {
+            sim.worstTicks = ticks;
+        }
+
+        if (sim.timing) {
+            fprintf(sim.timing, "%d,%lld\n", sim.frame - 1, TICKS_TO_US(ticks));
+        }
+    }
+
+    if (sim.frame >= sim.maxFrames) {
+        finish();
+    }
+
+    // a frame that missed a vertical blank waits for the one after it
+    while (sim.nextVblank <= now) {
+        sim.nextVblank += sim.frameTicks;
+    }
+
+    // skip to the vertical blank instead of waiting for it
+    sim.clockOffset += sim.nextVblank - now;
+    sim.frameStart = timer_ticks();
+    sim.frame++;
+
+    return &sim.display;
+}
+
+surface_t* display_get(void) {
+    return display_try_get();
+}
+
+float display_get_refresh_rate(void) {
+    return 60.0f;
+}
+
+/* RDP */
+
+/// @brief Reads an input of the combiner
+/// @param input Input to read
+/// @param tex Texel
+/// @param alpha Whether the alpha of the input is read
+/// @return Value of the input from 0 to 255
+static int combiner_input(sim_input_t input, color_t tex, bool alpha) {
+    switch (input) {
+        case IN_ONE:
+            return 255;
+        case IN_TEX0:
+            return alpha ? tex.a : -1;
+        case IN_PRIM:
+            return alpha ? sim.prim.a : -2;
+        case IN_TEX0_ALPHA:
+            return tex.a;
+        case IN_PRIM_ALPHA:
+            return sim.prim.a;
+        case IN_ENV:
+        case IN_ENV_ALPHA:
+        case IN_ZERO:
+        default:
+            return 0;
+    }
+}
+
+/// @brief Reads a color channel of an input of the combiner
+/// @param input Input to read
+/// @param tex Texel
+/// @param channel Channel from 0 to 2 for red, green and blue
+/// @return Value of the channel from 0 to 255
+static int combiner_channel(sim_input_t input, color_t tex, int channel) {
+    int value = combiner_input(input, tex, false);
+    const uint8_t* rgb = value == -1 ? &tex.r : &sim.prim.r;
+
+    return value < 0 ? rgb[channel] : value;
+}
+
+/// @brief Clamps a value to a byte
+static uint8_t clamp_byte(int value) {
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+/// @brief Runs the combiner set on a texel
+/// @param tex Texel
+/// @return Color coming out of the combiner
+static color_t combine(color_t tex) {
+    sim_combiner_t* comb;
+    color_t out;
+    uint8_t* channels = &out.r;
+
+    if (sim.combiner == 0) {
+        return tex;
+    }
+
+    comb = &sim.combiners[sim.combiner - 1];
+
+    for (int c = 0; c < 3; c++) {
+        int a = combiner_channel(comb->rgb[0], tex, c);
+        int b = combiner_channel(comb->rgb[1], tex, c);
+        int m = combiner_channel(comb->rgb[2], tex, c);
+        int d = combiner_channel(comb->rgb[3], tex, c);
+
+        channels[c] = clamp_byte((a - b) * m / 255 + d);
+    }
+
+    out.a = clamp_byte(
+        (combiner_input(comb->alpha[0], tex, true) - combiner_input(comb->alpha[1], tex, true)) *
+        combiner_input(comb->alpha[2], tex, true) / 255 +
+        combiner_input(comb->alpha[3], tex, true)
+    );
+
+    return out;
+}
+
+/// @brief Runs the blender set and writes a pixel to the surface drawn to
+/// @param x Column of the pixel
+/// @param y Row of the pixel
+/// @param in Color coming out of the combiner
+static void blend_pixel(int x, int y, color_t in) {
+    uint8_t* mem = (uint8_t*)sim.target->buffer + y * sim.target->stride + x * 4;
+
+    for (int c = 0; c < 3; c++) {
+        uint8_t p = (&in.r)[c];
+
+        switch (sim.blender) {
+            case RDPQ_BLENDER_MULTIPLY:
+                mem[c] = (p * in.a + mem[c] * (255 - in.a) + 127) / 255;
+                break;
+            case RDPQ_BLENDER_ADDITIVE:
+                mem[c] = clamp_byte(p * in.a / 255 + mem[c]);
+                break;
+            default:
+                mem[c] = p;
+                break;
+        }
+    }
+
+    mem[3] = 255;
+}
+
+/// @brief Reads a texel of a texture
+/// @param tex Texture
+/// @param s Column of the texel
+/// @param t Row of the texel
+/// @return Color of the texel
+static color_t read_texel(const surface_t* tex, int s, int t) {
+    const uint8_t* row = (const uint8_t*)tex->buffer + t * tex->stride;
+    uint8_t value;
+
+    switch (surface_get_format(tex)) {
+        case FMT_RGBA32:
+            return RGBA32(row[s * 4], row[s * 4 + 1], row[s * 4 + 2], row[s * 4 + 3]);
+        case FMT_RGBA16:
+            return unpack16(((const uint16_t*)row)[s]);
+        case FMT_I8:
+            return RGBA32(row[s], row[s], row[s], row[s]);
+        case FMT_IA8:
+            return RGBA32((row[s] >> 4) * 17, (row[s] >> 4) * 17, (row[s] >> 4) * 17, (row[s] & 15) * 17);
+        case FMT_CI8:
+            return unpack16(sim.tlut[row[s]]);
+        case FMT_CI4:
+            // the first pixel of each pair is in the high bits
+            value = (s & 1) ? row[s >> 1] & 15 : row[s >> 1] >> 4;
+            return unpack16(sim.tlut[value]);
+        default:
+            return RGBA32(255, 0, 255, 255);
+    }
+}
+
+/// @brief Samples a texture at a point with the filter set
+/// @param tex Texture
+/// @param s Horizontal texture coordinate in texels
+/// @param t Vertical texture coordinate in texels
+/// @param repeats Whether the texture repeats or clamps at its edges
+/// @return Filtered color
+static color_t sample(const surface_t* tex, float s, float t, bool repeats) {
+    int s0, t0, s1, t1;
+    float fs = 0.0f, ft = 0.0f;
+    color_t c[4], out;
+
+    if (sim.filter == FILTER_BILINEAR) {
+        s -= 0.5f;
+        t -= 0.5f;
+    }
+
+    s0 = (int)(s < 0.0f ? s - 1.0f : s);
+    t0 = (int)(t < 0.0f ? t - 1.0f : t);
+
+    if (sim.filter != FILTER_BILINEAR) {
+        s1 = s0;
+        t1 = t0;
+    }
+    else {
+        fs = s - s0;
+        ft = t - t0;
+        s1 = s0 + 1;
+        t1 = t0 + 1;
+    }
+
+    if (repeats) {
+        s0 = ((s0 % tex->width) + tex->width) % tex->width;
+        s1 = ((s1 % tex->width) + tex->width) % tex->width;
+        t0 = ((t0 % tex->height) + tex->height) % tex->height;
+        t1 = ((t1 % tex->height) + tex->height) % tex->height;
+    }
+    else {
+        s0 = s0 < 0 ? 0 : s0 >= tex->width ? tex->width - 1 : s0;
+        s1 = s1 < 0 ? 0 : s1 >= tex->width ? tex->width - 1 : s1;
+        t0 = t0 < 0 ? 0 : t0 >= tex->height ? tex->height - 1 : t0;
+        t1 = t1 < 0 ? 0 : t1 >= tex->height ? tex->height - 1 : t1;
+    }
+
+    c[0] = read_texel(tex, s0, t0);
+
+    if (sim.filter != FILTER_BILINEAR) {
+        return c[0];
+    }
+
+    c[1] = read_texel(tex, s1, t0);
+    c[2] = read_texel(tex, s0, t1);
+    c[3] = read_texel(tex, s1, t1);
+
+    for (int i = 0; i < 4; i++) {
+        float top = (&c[0].r)[i] + ((&c[1].r)[i] - (&c[0].r)[i]) * fs;
+        float bottom = (&c[2].r)[i] + ((&c[3].r)[i] - (&c[2].r)[i]) * fs;
+
+        (&out.r)[i] = clamp_byte((int)(top + (bottom - top) * ft + 0.5f));
+    }
+
+    return out;
+}
+
+/// @brief Draws a textured rectangle
+/// @param tex Texture
+/// @param repeats Whether the texture repeats or clamps at its edges
+/// @param x0 Left edge on screen
+/// @param y0 Top edge on screen
+/// @param x1 Right edge on screen
+/// @param y1 Bottom edge on screen
+/// @param s0 Texture column at the left edge
+/// @param t0 Texture row at the top edge
+/// @param s1 Texture column at the right edge
+/// @param t1 Texture row at the bottom edge
+static void draw_textured(const surface_t* tex, bool repeats, float x0, float y0, float x1, float y1, float s0, float t0, float s1, float t1) {
+    int left = (int)(x0 + 0.5f), top = (int)(y0 + 0.5f);
+    int right = (int)(x1 + 0.5f), bottom = (int)(y1 + 0.5f);
+    float ds = (s1 - s0) / (x1 - x0), dt = (t1 - t0) / (y1 - y0);
+
+    if (!sim.target || tex->width == 0 || tex->height == 0) {
+        return;
+    }
+
+    left = left < sim.scissor[0] ? sim.scissor[0] : left;
+    top = top < sim.scissor[1] ? sim.scissor[1] : top;
+    right = right > sim.scissor[2] ? sim.scissor[2] : right;
+    bottom = bottom > sim.scissor[3] ? sim.scissor[3] : bottom;
+
+    for (int y = top; y < bottom; y++) {
+        float t = t0 + (y + 0.5f - y0) * dt;
+
+        for (int x = left; x < right; x++) {
+            float s = s0 + (x + 0.5f - x0) * ds;
+
+            blend_pixel(x, y, combine(sample(tex, s, t, repeats)));
+        }
+    }
+}
+
+rdpq_combiner_t sim_combiner(const char* rgb, const char* alpha) {
+    static const char* input_names[] = {"0", "1", "TEX0", "PRIM", "ENV", "TEX0_ALPHA", "PRIM_ALPHA", "ENV_ALPHA"};
+    const char* texts[2] = {rgb, alpha};
+    sim_combiner_t* comb;
+
+    for (int i = 0; i < sim.numCombiners; i++) {
+        if (strcmp(sim.combiners[i].rgbText, rgb) == 0 && strcmp(sim.combiners[i].alphaText, alpha) == 0) {
+            return i + 1;
+        }
+    }
+
+    assertf(sim.numCombiners < MAX_COMBINERS, "Too many combiners");
+
+    comb = &sim.combiners[sim.numCombiners];
+    snprintf(comb->rgbText, sizeof(comb->rgbText), "%s", rgb);
+    snprintf(comb->alphaText, sizeof(comb->alphaText), "%s", alpha);
+
+    for (int half = 0; half < 2; half++) {
+        sim_input_t* inputs = half == 0 ? comb->rgb : comb->alpha;
+        const char* p = texts[half];
+
+        for (int slot = 0; slot < 4; slot++) {
+            char name[16];
+            int length = 0;
+            bool found = false;
+
+            while (*p == '(' || *p == ',' || *p == ' ') {
+                p++;
+            }
+
+            while (*p && *p != ',' && *p != ')' && *p != ' ' && length < 15) {
+                name[length++] = *p++;
+            }
+
+            name[length] = '\0';
+
+            for (size_t n = 0; n < sizeof(input_names) / sizeof(input_names[0]); n++) {
+                if (strcmp(name, input_names[n]) == 0) {
+                    inputs[slot] = (sim_input_t)n;
+                    found = true;
+                }
+            }
+
+            assertf(found, "Combiner input %s is not simulated", name);
+        }
+    }
+
+    return ++sim.numCombiners;
+}
+
+void rdpq_init(void) {}
+
+void rdpq_attach(const surface_t* surf_color, const surface_t* surf_z) {
+    (void)surf_z;
+
+    sim.target = surf_color;
+    rdpq_set_scissor(0, 0, surf_color->width, surf_color->height);
+}
+
+void rdpq_detach_show(void) {
+    if (sim.dumpDir && sim.dumpEvery > 0 && (sim.frame - 1) % sim.dumpEvery == 0) {
+        char name[64];
+
+        snprintf(name, sizeof(name), "frame%05d.ppm", sim.frame - 1);
+        dump_frame(name);
+    }
+
+    if (sim.dumpDir && is_held(SIM_DUMP)) {
+        char name[64];
+
+        snprintf(name, sizeof(name), "dump%05d.ppm", sim.frame - 1);
+        dump_frame(name);
+    }
+
+    sim.target = NULL;
+}
+
+void rdpq_set_mode_fill(color_t color) {
+    sim.fillMode = true;
+    sim.fillColor = color;
+}
+
+void rdpq_set_mode_standard(void) {
+    sim.fillMode = false;
+    sim.combiner = 0;
+    sim.blender = RDPQ_BLENDER_NONE;
+    sim.filter = FILTER_POINT;
+    sim.tlutMode = TLUT_NONE;
+}
+
+void rdpq_mode_combiner(rdpq_combiner_t comb) {
+    sim.combiner = comb;
+}
+
+void rdpq_mode_blender(rdpq_blender_t blend) {
+    sim.blender = blend;
+}
+
+void rdpq_mode_filter(rdpq_filter_t filt) {
+    sim.filter = filt;
+}
+
+void rdpq_mode_tlut(rdpq_tlut_t tlut) {
+    sim.tlutMode = tlut;
+}
+
+void rdpq_set_prim_color(color_t color) {
+    sim.prim = color;
+}
+
+void rdpq_set_scissor(int x0, int y0, int x1, int y1) {
+    sim.scissor[0] = x0 < 0 ? 0 : x0;
+    sim.scissor[1] = y0 < 0 ? 0 : y0;
+    sim.scissor[2] = x1 > FB_WIDTH ? FB_WIDTH : x1;
+    sim.scissor[3] = y1 > FB_HEIGHT ? FB_HEIGHT : y1;
+}
+
+void rdpq_fill_rectangle(float x0, float y0, float x1, float y1) {
+    uint32_t value;
+
+    assertf(sim.fillMode, "Rectangles are only simulated in fill mode");
+
+    if (!sim.target) {
+        return;
+    }
+
+    memcpy(&value, &sim.fillColor, sizeof(value));
+
+    for (int y = (int)y0 < sim.scissor[1] ? sim.scissor[1] : (int)y0; y < (int)y1 && y < sim.scissor[3]; y++) {
+        for (int x = (int)x0 < sim.scissor[0] ? sim.scissor[0] : (int)x0; x < (int)x1 && x < sim.scissor[2]; x++) {
+            memcpy((uint8_t*)sim.target->buffer + y * sim.target->stride + x * 4, &value, sizeof(value));
+        }
+    }
+}
+
+int rdpq_tex_upload(rdpq_tile_t tile, const surface_t* tex, const rdpq_texparms_t* parms) {
+    assertf(tile == TILE0, "Only TILE0 is simulated");
+
+    sim.tile = *tex;
+    sim.tileRepeats = parms && (parms->s.repeats > 1.0f || parms->t.repeats > 1.0f);
+
+    return 0;
+}
+
+void rdpq_tex_upload_tlut(uint16_t* tlut, int color_idx, int num_colors) {
+    memcpy(&sim.tlut[color_idx], tlut, num_colors * sizeof(uint16_t));
+}
+
+void rdpq_tex_blit(const surface_t* surf, float x0, float y0, const rdpq_blitparms_t* parms) {
+    float scale_x = parms && parms->scale_x != 0.0f ? parms->scale_x : 1.0f;
+    float scale_y = parms && parms->scale_y != 0.0f ? parms->scale_y : 1.0f;
+
+    assertf(!parms || (parms->theta == 0.0f && !parms->flip_x && !parms->flip_y), "Only scaled blits are simulated");
+
+    draw_textured(
+        surf,
+        false,
+        x0, y0, x0 + surf->width * scale_x, y0 + surf->height * scale_y,
+        0.0f, 0.0f, surf->width, surf->height
+    );
+}
+
+void rdpq_texture_rectangle_scaled(rdpq_tile_t tile, float x0, float y0, float x1, float y1, float s0, float t0, float s1, float t1) {
+    assertf(tile == TILE0, "Only TILE0 is simulated");
+
+    draw_textured(&sim.tile, sim.tileRepeats, x0, y0, x1, y1, s0, t0, s1, t1);
+}
+
+/* Display lists */
+
+/// @brief Stand-in for a recorded display list
+struct rspq_block_s {
+    int unused;
+};
+
+void rspq_block_begin(void) {}
+
+rspq_block_t* rspq_block_end(void) {
+    return (rspq_block_t*)calloc(1, sizeof(rspq_block_t));
+}
+
+void rspq_block_run(rspq_block_t* block) {
+    (void)block;
+}
+
+void rspq_block_free(rspq_block_t* block) {
+    free(block);
+}
+
+rspq_syncpoint_t rspq_syncpoint_new(void) {
+    static rspq_syncpoint_t last = 0;
+
+    return ++last;
+}
+
+void rspq_syncpoint_wait(rspq_syncpoint_t sync_id) {
+    // the simulated RDP draws as soon as it is told to so it is never behind
+    (void)sync_id;
+}
+
+/* Text */
+
+/// @brief Stand-in for a font
+struct rdpq_font_s {
+    int unused;
+};
+
+rdpq_font_t* rdpq_font_load_builtin(int font) {
+    static rdpq_font_t builtin;
+
+    (void)font;
+
+    return &builtin;
+}
+
+void rdpq_text_register_font(uint8_t font_id, const rdpq_font_t* font) {
+    (void)font_id;
+    (void)font;
+}
+
+int rdpq_text_printf(const rdpq_textparms_t* parms, uint8_t font_id, float x0, float y0, const char* fmt, ...) {
+    char text[1024];
+    va_list args;
+    int length;
+
+    // text is formatted so it takes CPU time as it does on the N64 but it is not drawn
+    (void)parms;
+    (void)font_id;
+    (void)x0;
+    (void)y0;
+
+    va_start(args, fmt);
+    length = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    return length;
+}
+
+/// @brief Reads an input script
+/// @param filename Name of the script
+/// @return true if the script was read
+static bool read_script(const char* filename) {
+    FILE* fp = (fopen)(filename, "r");
+    char line[256];
+
+    if (!fp) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        char name[32];
+        sim_event_t event = {.frames = 1};
+        int fields = sscanf(line, "%d %31s %d", &event.frame, name, &event.frames);
+        bool found = false;
+
+        // blank lines and lines starting with # are skipped
+        if (fields < 2 || line[0] == '#') {
+            continue;
+        }
+
+        for (int b = 0; b < SIM_BUTTONS; b++) {
+            if (strcmp(name, button_names[b]) == 0) {
+                event.button = (sim_button_t)b;
+                found = true;
+            }
+        }
+
+        if (!found || sim.numEvents >= MAX_EVENTS) {
+            fprintf(stderr, "Cannot use script line: %s", line);
+            fclose(fp);
+            return false;
+        }
+
+        sim.events[sim.numEvents++] = event;
+    }
+
+    fclose(fp);
+    return true;
+}
+
+/// @brief Prints how to use the simulator
+/// @param name Name of the program
+static void usage(const char* name) {
+    fprintf(
+        stderr,
+        "usage: %s [-f frames] [-m megabytes] [-s script] [-d dump directory] [-e every] [-t timing.csv] filesystem\n"
+        "  -f  frames to run, 600 by default\n"
+        "  -m  RDRAM of the N64 in megabytes, 4 by default or 8 for an Expansion Pak\n"
+        "  -s  input script with lines of: frame button [frames held]\n"
+        "      buttons are a b z start d_up d_down d_left d_right l r c_up c_down c_left c_right\n"
+        "      stick_left stick_right, and dump to write the frame to the dump directory\n"
+        "  -d  directory to write frames to as PPM images\n"
+        "  -e  write every nth frame to the dump directory. 0 writes only the last frame\n"
+        "  -t  CSV file of the microseconds of CPU time each frame took\n",
+        name
+    );
+}
+
+int main(int argc, char** argv) {
+    int i;
+
+    sim.maxFrames = 600;
+    sim.memorySize = 4 << 20;
+
+    for (i = 1; i < argc - 1 && argv[i][0] == '-'; i += 2) {
+        switch (argv[i][1]) {
+            case 'f':
+                sim.maxFrames = atoi(argv[i + 1]);
+                break;
+            case 'm':
+                sim.memorySize = atoi(argv[i + 1]) << 20;
+                break;
+            case 's':
+                if (!read_script(argv[i + 1])) {
+                    fprintf(stderr, "Cannot read %s\n", argv[i + 1]);
+                    return 1;
+                }
+                break;
+            case 'd':
+                sim.dumpDir = argv[i + 1];
+                break;
+            case 'e':
+                sim.dumpEvery = atoi(argv[i + 1]);
+                break;
+            case 't':
+                if (!(sim.timing = (fopen)(argv[i + 1], "w"))) {
+                    fprintf(stderr, "Cannot write %s\n", argv[i + 1]);
+                    return 1;
+                }
+                fprintf(sim.timing, "frame,cpu_us\n");
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (i != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    sim.fsDir = argv[i];
+
+    return viewer_main();
+}